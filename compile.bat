@@ -1,12 +1,15 @@
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\2d.vert -o data\shaders\2d.vert.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\2d.frag -o data\shaders\2d.frag.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\3d.vert -o data\shaders\3d.vert.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\3d.frag -o data\shaders\3d.frag.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\material_pbr.vert -o data\shaders\material_pbr.vert.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\material_pbr.frag -o data\shaders\material_pbr.frag.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\3d.frag -o data\shaders\3d.frag.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\point_light.vert -o data\shaders\point_light.vert.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\point_light.frag -o data\shaders\point_light.frag.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\texture_pbr.vert -o data\shaders\texture_pbr.vert.spv
-C:\VulkanSDK\1.3.261.1\Bin\glslc.exe data\shaders\texture_pbr.frag -o data\shaders\texture_pbr.frag.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\2d.vert -o data\shaders\2d.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\2d.frag -o data\shaders\2d.frag.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\3d.vert -o data\shaders\3d.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\3d_packed.vert -o data\shaders\3d_packed.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\3d_packed_color.vert -o data\shaders\3d_packed_color.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\3d.frag -o data\shaders\3d.frag.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\material_pbr.vert -o data\shaders\material_pbr.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\material_pbr_packed.vert -o data\shaders\material_pbr_packed.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\material_pbr.frag -o data\shaders\material_pbr.frag.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\point_light.vert -o data\shaders\point_light.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\point_light.frag -o data\shaders\point_light.frag.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\texture_pbr.vert -o data\shaders\texture_pbr.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\texture_pbr_packed.vert -o data\shaders\texture_pbr_packed.vert.spv
+"%VULKAN_SDK%\Bin\glslc.exe" data\shaders\texture_pbr.frag -o data\shaders\texture_pbr.frag.spv
 pause
\ No newline at end of file
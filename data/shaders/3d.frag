@@ -23,12 +23,6 @@ layout (set = 0, binding = 0) uniform global_ubo
     int num_lights;
 } ubo;
 
-layout (push_constant) uniform Push 
-{
-    mat4 model_matrix;
-    mat4 normal_matrix;
-} push;
-
 void main()
 {
     vec3 diffuse_light  = ubo.ambient_light_color.rgb * ubo.ambient_light_color.w;
@@ -27,18 +27,18 @@ layout (set = 0, binding = 0) uniform global_ubo
     int num_lights;
 } ubo;
 
-layout (push_constant) uniform Push 
+layout (set = 1, binding = 0) uniform object_ubo
 {
     mat4 model_matrix;
     mat4 normal_matrix;
-} push;
+} object;
 
 void main()
 {
-    vec4 position = push.model_matrix * vec4(in_position, 1.0f);
+    vec4 position = object.model_matrix * vec4(in_position, 1.0f);
     gl_Position   = ubo.projection * (ubo.view * position);
     
-    out_normal   = normalize(mat3(push.normal_matrix) * in_normal);
+    out_normal   = normalize(mat3(object.normal_matrix) * in_normal);
     out_position = position.xyz;
     out_color    = in_color;
     out_uv       = in_uv;
@@ -0,0 +1,54 @@
+#version 450
+
+layout (location = 0) in vec4 in_position; // quantized, the model matrix holds the dequantization
+layout (location = 1) in vec4 in_color;
+layout (location = 2) in vec2 in_normal;  // octahedral
+layout (location = 3) in vec2 in_uv;
+layout (location = 4) in vec2 in_tangent; // octahedral
+
+layout (location = 0) out vec3 out_color;
+layout (location = 1) out vec3 out_position;
+layout (location = 2) out vec3 out_normal;
+layout (location = 3) out vec2 out_uv;
+
+struct point_light
+{
+    vec4 position; // ignore w
+    vec4 color; // w is intensity
+};
+
+layout (set = 0, binding = 0) uniform global_ubo
+{
+    mat4 projection;
+    mat4 view;
+    mat4 inverse_view;
+    vec4 ambient_light_color; // w is intensity
+    point_light point_lights[10];
+    int num_lights;
+} ubo;
+
+layout (set = 1, binding = 0) uniform object_ubo
+{
+    mat4 model_matrix;
+    mat4 normal_matrix;
+} object;
+
+// Inverse of the octahedral mapping in model.cpp
+vec3 octahedral_decode(vec2 encoded)
+{
+    vec3  direction = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold      = max(-direction.z, 0.0f);
+    direction.xy   += vec2(direction.x >= 0.0f ? -fold : fold, direction.y >= 0.0f ? -fold : fold);
+    return normalize(direction);
+}
+
+void main()
+{
+    vec4 position = object.model_matrix * vec4(in_position.xyz, 1.0f);
+    gl_Position   = ubo.projection * (ubo.view * position);
+    
+    out_normal   = normalize(mat3(object.normal_matrix) * octahedral_decode(in_normal));
+    out_position = position.xyz;
+    out_color    = in_color.rgb;
+    out_uv       = in_uv;
+}
\ No newline at end of file
@@ -29,7 +29,7 @@ layout (set = 0, binding = 0) uniform global_ubo
 const vec3 dielectric = vec3(0.04f);
 const float ambient = 0.01f;
 
-layout (push_constant) uniform Push
+layout (set = 1, binding = 0) uniform object_ubo
 {
     mat4  model_matrix;
     mat4  normal_matrix;
@@ -38,7 +38,7 @@ layout (push_constant) uniform Push
     float b;
     float metallic;
     float roughness;
-} push;
+} object;
 
 /*
     * light          : light source
@@ -157,9 +157,9 @@ void main()
     vec3 camera_pos_world = ubo.inverse_view[3].xyz;
     vec3 view_dir         = normalize(camera_pos_world - in_position);
 
-    vec3 base_color = vec3(push.r, push.g, push.b);
-    float metallic  = push.metallic;
-    float roughness = push.roughness;
+    vec3 base_color = vec3(object.r, object.g, object.b);
+    float metallic  = object.metallic;
+    float roughness = object.roughness;
 
     out_color.rgb = base_color * ambient;
     out_color.a   = 1.0f;
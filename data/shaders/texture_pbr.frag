@@ -33,8 +33,6 @@ layout (set = 0, binding = 4) uniform sampler2D gloss_texture;
 
 layout (push_constant) uniform Push
 {
-    mat4 model_matrix;
-    mat4 normal_matrix;
     int  shading_mode;
     bool use_normal_map;
 } push;
@@ -28,22 +28,19 @@ layout (set = 0, binding = 0) uniform global_ubo
     int num_lights;
 } ubo;
 
-// There must be no more than one push constant block statically used per shader entry point.
-layout (push_constant) uniform Push
+layout (set = 1, binding = 0) uniform object_ubo
 {
     mat4 model_matrix;
     mat4 normal_matrix;
-    int  shading_mode;
-    bool use_normal_map;
-} push;
+} object;
 
 void main()
 {
-    vec4 position_world = push.model_matrix * vec4(in_position, 1.0f);
+    vec4 position_world = object.model_matrix * vec4(in_position, 1.0f);
     gl_Position         = ubo.projection * (ubo.view * position_world);
 
-    out_normal   = normalize(mat3(push.normal_matrix) * in_normal);
-    out_tangent  = normalize(mat3(push.normal_matrix) * in_tangent.xyz);
+    out_normal   = normalize(mat3(object.normal_matrix) * in_normal);
+    out_tangent  = normalize(mat3(object.normal_matrix) * in_tangent.xyz);
     out_position = position_world.xyz;
     out_color    = in_color;
     out_uv       = in_uv;
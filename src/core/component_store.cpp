@@ -0,0 +1,210 @@
+#include "component_store.h"
+
+// Project includes
+#include "src/core/transform_kernel.h"
+#include "src/utility/frame_arena.h"
+
+// Standard includes
+#include <cassert>
+#include <stdexcept>
+
+namespace dae
+{
+    namespace
+    {
+        constexpr uint32_t no_index = std::numeric_limits<uint32_t>::max();
+    }
+
+    void component_store::set_parent(entity child, entity parent)
+    {
+        for (entity ancestor = parent; ancestor != no_entity; ancestor = this->parent(ancestor))
+        {
+            if (ancestor == child)
+            {
+                throw std::runtime_error{"An object cannot be parented to itself or one of its children"};
+            }
+        }
+
+        if (entity *parent_ptr = parents_.find(child))
+        {
+            *parent_ptr = parent;
+        }
+        else
+        {
+            parents_.emplace(child, parent);
+        }
+        hierarchy_changed_ = true;
+    }
+
+    void component_store::remove_parent(entity child)
+    {
+        remove_if_present(parents_, child);
+        hierarchy_changed_ = true;
+    }
+
+    auto component_store::update_transforms() -> size_t
+    {
+        // Objects created since the last update are appended to the transforms, outside the order
+        bool const rebuilt = hierarchy_changed_ or parent_indices_.size() != transforms_.size();
+        if (rebuilt)
+        {
+            rebuild_hierarchy();
+        }
+
+        auto const transforms = transforms_.components();
+
+        auto &arena   = frame_arena::instance();
+        auto dirty    = arena.make_vector<uint32_t>();
+        auto changed  = arena.make_vector<uint8_t>(transforms.size());
+        for (uint32_t i = 0; i < transforms.size(); ++i)
+        {
+            if (transforms[i].is_dirty())
+            {
+                dirty.push_back(i);
+            }
+            changed.push_back(rebuilt or transforms[i].is_dirty());
+        }
+
+        if (not dirty.empty())
+        {
+            // Gathered into the structure of arrays layout the kernel reads, nine floats per transform
+            auto inputs = arena.make_vector<float>();
+            inputs.resize(dirty.size() * 9);
+            float *const columns[9] = {
+                inputs.data() + dirty.size() * 0, inputs.data() + dirty.size() * 1, inputs.data() + dirty.size() * 2,
+                inputs.data() + dirty.size() * 3, inputs.data() + dirty.size() * 4, inputs.data() + dirty.size() * 5,
+                inputs.data() + dirty.size() * 6, inputs.data() + dirty.size() * 7, inputs.data() + dirty.size() * 8,
+            };
+            for (size_t i = 0; i < dirty.size(); ++i)
+            {
+                transform_component const &transform = transforms[dirty[i]];
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    columns[0 + axis][i] = transform.translation_[axis];
+                    columns[3 + axis][i] = transform.rotation_[axis];
+                    columns[6 + axis][i] = transform.scale_[axis];
+                }
+            }
+
+            auto local_matrices        = arena.make_vector<glm::mat4>();
+            auto local_normal_matrices = arena.make_vector<glm::mat4>();
+            local_matrices.resize(dirty.size());
+            local_normal_matrices.resize(dirty.size());
+
+            transform_kernel::compose(
+                {columns[0], columns[1], columns[2], columns[3], columns[4], columns[5], columns[6], columns[7], columns[8]},
+                dirty.size(),
+                local_matrices.data(),
+                local_normal_matrices.data());
+
+            for (size_t i = 0; i < dirty.size(); ++i)
+            {
+                transform_component &transform = transforms[dirty[i]];
+                transform.local_matrix_        = local_matrices[i];
+                transform.local_normal_matrix_ = local_normal_matrices[i];
+                transform.dirty_               = false;
+            }
+        }
+
+        // Parents come first, so a changed one is final before its children read it. Normal matrices of a product
+        // are the product of the normal matrices, the inverse transpose distributes like the inverse.
+        for (uint32_t i = 0; i < transforms.size(); ++i)
+        {
+            uint32_t const parent = parent_indices_[i];
+            if (parent != no_index and changed[parent])
+            {
+                changed[i] = true;
+            }
+            if (not changed[i])
+            {
+                continue;
+            }
+
+            transform_component &transform = transforms[i];
+            if (parent == no_index)
+            {
+                transform.world_matrix_        = transform.local_matrix_;
+                transform.world_normal_matrix_ = transform.local_normal_matrix_;
+            }
+            else
+            {
+                transform.world_matrix_        = transforms[parent].world_matrix_ * transform.local_matrix_;
+                transform.world_normal_matrix_ = transforms[parent].world_normal_matrix_ * transform.local_normal_matrix_;
+            }
+        }
+        return dirty.size();
+    }
+
+    void component_store::rebuild_hierarchy()
+    {
+        size_t const count    = transforms_.size();
+        auto const   entities = transforms_.entities();
+        auto        &arena    = frame_arena::instance();
+
+        // Parents without a transform, destroyed ones included, leave their children as roots
+        auto parent_of = arena.make_vector<uint32_t>(count);
+        for (entity const id : entities)
+        {
+            entity const parent = this->parent(id);
+            parent_of.push_back(parent != no_entity and transforms_.contains(parent) ? transforms_.index_of(parent) : no_index);
+        }
+
+        // Children grouped by parent, first_child[p] to first_child[p + 1] in children
+        auto first_child = arena.make_vector<uint32_t>(count + 1);
+        first_child.resize(count + 1, 0);
+        for (uint32_t const parent : parent_of)
+        {
+            if (parent != no_index)
+            {
+                ++first_child[parent + 1];
+            }
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            first_child[i + 1] += first_child[i];
+        }
+        auto children = arena.make_vector<uint32_t>();
+        children.resize(first_child[count]);
+        auto filled = arena.make_vector<uint32_t>(count);
+        filled.assign(first_child.begin(), first_child.end() - 1);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (parent_of[i] != no_index)
+            {
+                children[filled[parent_of[i]]++] = i;
+            }
+        }
+
+        // Roots in their current order, then level by level, the order itself is the queue
+        auto order = arena.make_vector<uint32_t>(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (parent_of[i] == no_index)
+            {
+                order.push_back(i);
+            }
+        }
+        for (size_t head = 0; head < order.size(); ++head)
+        {
+            uint32_t const node = order[head];
+            order.insert(order.end(), children.begin() + first_child[node], children.begin() + first_child[node + 1]);
+        }
+        assert(order.size() == count and "Hierarchy has a cycle");
+
+        auto position = arena.make_vector<uint32_t>();
+        position.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            position[order[i]] = i;
+        }
+
+        parent_indices_.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t const parent = parent_of[order[i]];
+            parent_indices_[i] = parent == no_index ? no_index : position[parent];
+        }
+        transforms_.permute(order);
+        hierarchy_changed_ = false;
+    }
+}
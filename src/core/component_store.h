@@ -0,0 +1,99 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/components.h"
+#include "src/core/sparse_set.h"
+
+// Standard includes
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+    // Every component of a scene's objects, one sparse set per component type. Systems iterate the dense array of
+    // the component they draw and look the others up by entity. Objects created in the same order get their
+    // components at the same dense index, so those lookups walk the other arrays front to back as well.
+    //
+    // Objects can have a parent, the transforms are kept in breadth-first order of that hierarchy so every parent
+    // comes before its children and world matrices are carried down in a single sweep over the dense array. The order
+    // is rebuilt on the next update after the hierarchy or the set of transforms changed.
+    class component_store final
+    {
+    public:
+        using entity = sparse_set<transform_component>::entity;
+
+        static constexpr entity no_entity = std::numeric_limits<entity>::max();
+
+        component_store() = default;
+        ~component_store() = default;
+
+        component_store(component_store const &)            = delete;
+        component_store(component_store &&)                 = delete;
+        component_store &operator=(component_store const &) = delete;
+        component_store &operator=(component_store &&)      = delete;
+
+        // Entities are never reused, the sparse arrays only grow to the number ever created
+        auto create() -> entity { return next_entity_++; }
+
+        void destroy(entity id)
+        {
+            remove_if_present(names_, id);
+            remove_if_present(transforms_, id);
+            remove_if_present(meshes_, id);
+            remove_if_present(materials_, id);
+            remove_if_present(point_lights_, id);
+            remove_if_present(parents_, id);
+
+            // Children of a destroyed object become roots
+            hierarchy_changed_ = true;
+        }
+
+        // The child's transform becomes relative to the parent's, throws when the parent is the child or below it
+        void set_parent(entity child, entity parent);
+        void remove_parent(entity child);
+
+        // no_entity for roots
+        [[nodiscard]] auto parent(entity child) const -> entity
+        {
+            entity const *parent_ptr = parents_.find(child);
+            return parent_ptr ? *parent_ptr : no_entity;
+        }
+
+        // Composes the local matrices of every transform changed since the last call and the world matrices of those
+        // and everything below them, returns how many were changed. Uses the frame arena, so only from the frame loop.
+        auto update_transforms() -> size_t;
+
+        [[nodiscard]] auto names() -> sparse_set<std::string> & { return names_; }
+        [[nodiscard]] auto transforms() -> sparse_set<transform_component> & { return transforms_; }
+        [[nodiscard]] auto meshes() -> sparse_set<mesh_component> & { return meshes_; }
+        [[nodiscard]] auto materials() -> sparse_set<material_component> & { return materials_; }
+        [[nodiscard]] auto point_lights() -> sparse_set<point_light_component> & { return point_lights_; }
+
+    private:
+        void rebuild_hierarchy();
+
+        template <typename T>
+        static void remove_if_present(sparse_set<T> &set, entity id)
+        {
+            if (set.contains(id))
+            {
+                set.remove(id);
+            }
+        }
+
+        sparse_set<std::string>           names_        = {}; // cold, only read while loading
+        sparse_set<transform_component>   transforms_   = {};
+        sparse_set<mesh_component>        meshes_       = {};
+        sparse_set<material_component>    materials_    = {};
+        sparse_set<point_light_component> point_lights_ = {};
+        sparse_set<entity>                parents_      = {};
+
+        // Dense index of each transform's parent, parallel to transforms_ and in its breadth-first order
+        std::vector<uint32_t> parent_indices_    = {};
+        bool                  hierarchy_changed_ = false;
+
+        entity next_entity_ = 0;
+    };
+}
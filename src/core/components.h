@@ -0,0 +1,83 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+#include "src/utility/material.h"
+
+// Standard includes
+#include <cassert>
+#include <memory>
+
+// GLM includes
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace dae
+{
+    // Forward declarations
+    class component_store;
+
+    // Translation, scale and Tait-Bryan rotation (Y, X, Z) relative to the parent, with the local and world matrices
+    // cached. The setters mark the transform dirty, component_store::update_transforms composes every dirty local
+    // matrix in a single batch through transform_kernel, then carries the world matrices down the hierarchy below
+    // whatever changed, so static objects never evaluate sin and cos or multiply matrices again.
+    class transform_component final
+    {
+    public:
+        [[nodiscard]] auto translation() const -> glm::vec3 const & { return translation_; }
+        [[nodiscard]] auto scale() const -> glm::vec3 const & { return scale_; }
+        [[nodiscard]] auto rotation() const -> glm::vec3 const & { return rotation_; }
+
+        void set_translation(glm::vec3 const &translation) { translation_ = translation; dirty_ = true; }
+        void set_scale(glm::vec3 const &scale) { scale_ = scale; dirty_ = true; }
+        void set_rotation(glm::vec3 const &rotation) { rotation_ = rotation; dirty_ = true; }
+
+        [[nodiscard]] auto is_dirty() const -> bool { return dirty_; }
+
+        // World matrices, valid once updated after the last change to this transform or one of its ancestors
+        [[nodiscard]] auto mat4() const -> glm::mat4 const &
+        {
+            assert(not dirty_ and "Transform changed since its matrices were updated");
+            return world_matrix_;
+        }
+
+        [[nodiscard]] auto normal_matrix() const -> glm::mat4 const &
+        {
+            assert(not dirty_ and "Transform changed since its matrices were updated");
+            return world_normal_matrix_;
+        }
+
+        // Relative to the parent, the same as the world ones without a parent
+        [[nodiscard]] auto local_matrix() const -> glm::mat4 const &
+        {
+            assert(not dirty_ and "Transform changed since its matrices were updated");
+            return local_matrix_;
+        }
+
+    private:
+        friend class component_store;
+
+        glm::vec3 translation_ = {};
+        glm::vec3 scale_       = {1.0f, 1.0f, 1.0f};
+        glm::vec3 rotation_    = {};
+        bool      dirty_       = true;
+
+        glm::mat4 local_matrix_        = {1.0f};
+        glm::mat4 local_normal_matrix_ = {1.0f};
+        glm::mat4 world_matrix_        = {1.0f};
+        glm::mat4 world_normal_matrix_ = {1.0f};
+    };
+
+    struct mesh_component
+    {
+        std::shared_ptr<model> model       = {}; // shared between instances through the mesh_registry
+        bool                   use_texture = false;
+    };
+
+    using material_component = material;
+
+    struct point_light_component
+    {
+        glm::vec3 color           = {};
+        float     light_intensity = 1.0f;
+    };
+}
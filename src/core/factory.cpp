@@ -33,6 +33,8 @@ namespace dae
         modelBuilder.indices.push_back(0);
         modelBuilder.indices.push_back(segments);
         modelBuilder.indices.push_back(1);
+        modelBuilder.compute_bounds();
+        modelBuilder.select_index_type();
 
         return std::make_unique<model>(modelBuilder);
     }
@@ -68,6 +70,43 @@ namespace dae
         modelBuilder.indices.push_back(0);
         modelBuilder.indices.push_back(sides - 1);
         modelBuilder.indices.push_back(1);
+        modelBuilder.compute_bounds();
+        modelBuilder.select_index_type();
+
+        return std::make_unique<model>(modelBuilder);
+    }
+
+    std::unique_ptr<model> factory::create_cube(float size)
+    {
+        model::builder modelBuilder{};
+        float const half = size * 0.5f;
+
+        // One quad per face so every face keeps its own normal and uv layout
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (float sign : {-1.0f, 1.0f})
+            {
+                glm::vec3 normal{};
+                normal[axis] = sign;
+                glm::vec3 u{};
+                u[(axis + 1) % 3] = sign;
+                glm::vec3 v{};
+                v[(axis + 2) % 3] = 1.0f;
+
+                auto const first = static_cast<uint32_t>(modelBuilder.vertices.size());
+                for (glm::vec2 corner : {glm::vec2{0, 0}, glm::vec2{1, 0}, glm::vec2{1, 1}, glm::vec2{0, 1}})
+                {
+                    glm::vec3 const position = (normal + u * (corner.x * 2.0f - 1.0f) + v * (corner.y * 2.0f - 1.0f)) * half;
+                    modelBuilder.vertices.push_back({position, {1.0f, 1.0f, 1.0f}, normal, corner});
+                }
+
+                modelBuilder.indices.insert(modelBuilder.indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+            }
+        }
+
+        modelBuilder.generate_tangents();
+        modelBuilder.compute_bounds();
+        modelBuilder.select_index_type();
 
         return std::make_unique<model>(modelBuilder);
     }
@@ -12,5 +12,6 @@ namespace dae
     {
         static std::unique_ptr<model> create_oval(glm::vec3 offset, float radiusX, float radiusY, int segments);
         static std::unique_ptr<model> create_n_gon(glm::vec3 offset, float radius, int sides);
+        static std::unique_ptr<model> create_cube(float size);
     };
 }
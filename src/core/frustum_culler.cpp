@@ -0,0 +1,155 @@
+﻿#include "frustum_culler.h"
+
+// Project includes
+#include "src/engine/camera.h"
+#include "src/utility/frame_arena.h"
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define DAE_FRUSTUM_CULLER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace dae
+{
+    namespace
+    {
+        // World bounds of meshes [first, last), the box's world extent is its local one through the absolute matrix
+        void gather(component_store &components, size_t first, size_t last, bounds_soa const &bounds)
+        {
+            auto &transforms    = components.transforms();
+            auto const meshes   = components.meshes().components();
+            auto const entities = components.meshes().entities();
+            for (size_t i = first; i < last; ++i)
+            {
+                model const &mesh = *meshes[i].model;
+                glm::mat4 const &matrix = transforms.get(entities[i]).mat4();
+
+                model::sphere const &sphere = mesh.bounding_sphere();
+                glm::vec3 const local_half_extent = (mesh.bounds().max - mesh.bounds().min) * 0.5f;
+                glm::vec3 const center = glm::vec3{matrix * glm::vec4{sphere.center, 1.0f}};
+
+                glm::mat3 const linear{matrix};
+                float const scale = std::sqrt(std::max({
+                    glm::dot(linear[0], linear[0]), glm::dot(linear[1], linear[1]), glm::dot(linear[2], linear[2])}));
+                glm::vec3 const half_extent =
+                    glm::abs(linear[0]) * local_half_extent.x + glm::abs(linear[1]) * local_half_extent.y + glm::abs(linear[2]) * local_half_extent.z;
+
+                bounds.center_x[i]      = center.x;
+                bounds.center_y[i]      = center.y;
+                bounds.center_z[i]      = center.z;
+                bounds.radius[i]        = sphere.radius * scale;
+                bounds.half_extent_x[i] = half_extent.x;
+                bounds.half_extent_y[i] = half_extent.y;
+                bounds.half_extent_z[i] = half_extent.z;
+            }
+        }
+
+        void test_range(std::array<glm::vec4, 6> const &planes, bounds_soa const &bounds, size_t first, size_t last, uint8_t *visible)
+        {
+#if defined(DAE_FRUSTUM_CULLER_SSE2)
+            __m128 const sign_mask = _mm_set1_ps(-0.0f);
+
+            size_t i = first;
+            for (; i + 4 <= last; i += 4)
+            {
+                __m128 const center_x      = _mm_loadu_ps(bounds.center_x + i);
+                __m128 const center_y      = _mm_loadu_ps(bounds.center_y + i);
+                __m128 const center_z      = _mm_loadu_ps(bounds.center_z + i);
+                __m128 const radius        = _mm_loadu_ps(bounds.radius + i);
+                __m128 const half_extent_x = _mm_loadu_ps(bounds.half_extent_x + i);
+                __m128 const half_extent_y = _mm_loadu_ps(bounds.half_extent_y + i);
+                __m128 const half_extent_z = _mm_loadu_ps(bounds.half_extent_z + i);
+
+                __m128 outside = _mm_setzero_ps();
+                for (auto const &plane : planes)
+                {
+                    __m128 const normal_x = _mm_set1_ps(plane.x);
+                    __m128 const normal_y = _mm_set1_ps(plane.y);
+                    __m128 const normal_z = _mm_set1_ps(plane.z);
+
+                    __m128 distance = _mm_add_ps(_mm_mul_ps(normal_x, center_x), _mm_set1_ps(plane.w));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(normal_y, center_y));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(normal_z, center_z));
+
+                    __m128 box_radius = _mm_mul_ps(_mm_andnot_ps(sign_mask, normal_x), half_extent_x);
+                    box_radius = _mm_add_ps(box_radius, _mm_mul_ps(_mm_andnot_ps(sign_mask, normal_y), half_extent_y));
+                    box_radius = _mm_add_ps(box_radius, _mm_mul_ps(_mm_andnot_ps(sign_mask, normal_z), half_extent_z));
+
+                    __m128 const extent = _mm_min_ps(radius, box_radius);
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_xor_ps(extent, sign_mask)));
+                }
+
+                int const outside_bits = _mm_movemask_ps(outside);
+                visible[i + 0] = (outside_bits & 1) == 0;
+                visible[i + 1] = (outside_bits & 2) == 0;
+                visible[i + 2] = (outside_bits & 4) == 0;
+                visible[i + 3] = (outside_bits & 8) == 0;
+            }
+            frustum_culler::test_scalar(planes, bounds, i, last, visible);
+#else
+            frustum_culler::test_scalar(planes, bounds, first, last, visible);
+#endif
+        }
+    }
+
+    auto frustum_culler::cull(camera const &camera, component_store &components, statistics &stats) -> std::pmr::vector<uint32_t>
+    {
+        size_t const count = components.meshes().size();
+        auto &arena = frame_arena::instance();
+
+        auto floats = arena.make_vector<float>();
+        floats.resize(count * 7);
+        bounds_soa const bounds{
+            floats.data() + count * 0,
+            floats.data() + count * 1,
+            floats.data() + count * 2,
+            floats.data() + count * 3,
+            floats.data() + count * 4,
+            floats.data() + count * 5,
+            floats.data() + count * 6,
+        };
+        auto visible = arena.make_vector<uint8_t>();
+        visible.resize(count);
+
+        // Runs every frame for every system, so it stays on this thread, parallel_for would start threads each call
+        gather(components, 0, count, bounds);
+        test_range(camera.frustum_planes(), bounds, 0, count, visible.data());
+
+        auto indices = arena.make_vector<uint32_t>(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (visible[i])
+            {
+                indices.push_back(i);
+            }
+        }
+
+        stats.visible = indices.size();
+        stats.culled  = count - indices.size();
+        return indices;
+    }
+
+    void frustum_culler::test(std::array<glm::vec4, 6> const &planes, bounds_soa const &bounds, size_t count, uint8_t *visible)
+    {
+        test_range(planes, bounds, 0, count, visible);
+    }
+
+    void frustum_culler::test_scalar(std::array<glm::vec4, 6> const &planes, bounds_soa const &bounds, size_t first, size_t last, uint8_t *visible)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            bool outside = false;
+            for (auto const &plane : planes)
+            {
+                float const distance   = plane.x * bounds.center_x[i] + plane.w + plane.y * bounds.center_y[i] + plane.z * bounds.center_z[i];
+                float const box_radius = std::abs(plane.x) * bounds.half_extent_x[i] + std::abs(plane.y) * bounds.half_extent_y[i] + std::abs(plane.z) * bounds.half_extent_z[i];
+                outside = outside or distance < -std::min(bounds.radius[i], box_radius);
+            }
+            visible[i] = not outside;
+        }
+    }
+}
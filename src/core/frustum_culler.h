@@ -0,0 +1,57 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/component_store.h"
+
+// Standard includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// GLM includes
+#include <glm/glm.hpp>
+
+namespace dae
+{
+    // Forward declarations
+    class camera;
+
+    // World space bounds of objects as a structure of arrays, every pointer addresses count floats. The sphere and
+    // the box share the center, half_extent is the box's extent along the world axes.
+    struct bounds_soa
+    {
+        float *center_x      = nullptr;
+        float *center_y      = nullptr;
+        float *center_z      = nullptr;
+        float *radius        = nullptr;
+        float *half_extent_x = nullptr;
+        float *half_extent_y = nullptr;
+        float *half_extent_z = nullptr;
+    };
+
+    // Culls the meshes of a component store against the view frustum before a system records its draws. The world
+    // bounds of every mesh are gathered from its model's bounding sphere and aabb, then tested four at a time per
+    // plane with SSE2, all on the calling thread.
+    class frustum_culler final
+    {
+    public:
+        struct statistics
+        {
+            uint64_t visible = 0;
+            uint64_t culled  = 0;
+        };
+
+        // Dense indices into components.meshes() that intersect the camera's frustum, in order. Allocated from the
+        // frame arena, so only from the frame loop.
+        static auto cull(camera const &camera, component_store &components, statistics &stats) -> std::pmr::vector<uint32_t>;
+
+        // Sets visible[i] to 1 where the object's bounds intersect every plane, 0 where one plane has them outside.
+        // Tighter of the sphere and the box per plane.
+        static void test(std::array<glm::vec4, 6> const &planes, bounds_soa const &bounds, size_t count, uint8_t *visible);
+
+        // Scalar reference of test
+        static void test_scalar(std::array<glm::vec4, 6> const &planes, bounds_soa const &bounds, size_t first, size_t last, uint8_t *visible);
+    };
+}
@@ -1,68 +1,63 @@
 ﻿#pragma once
 
 // Project includes
-#include "src/core/model.h"
-#include "src/utility/material.h"
+#include "src/core/component_store.h"
 
 // Standard includes
 #include <memory>
 #include <string>
 
-// GLM includes
-#include <glm/gtc/matrix_transform.hpp>
-
 namespace dae
 {
-    struct transform_component
-    {
-        glm::vec3 translation = {};
-        glm::vec3 scale       = {1.0f, 1.0f, 1.0f};
-        glm::vec3 rotation    = {};
-        glm::mat4 mat4();
-        glm::mat4 normal_matrix();
-    };
-
-    struct point_light_component
-    {
-        float light_intensity = 1.0f;
-    };
-    
+    // Handle to an entity of a scene's component_store, cheap to copy and valid as long as the scene. The data lives
+    // in the store's dense arrays, this only finds it.
     class game_object final
     {
     public:
-        using id_t = unsigned int;
+        using id_t = component_store::entity;
 
     public:
-        explicit game_object(std::string name) : id_{next_id_++}, name_{std::move(name)} {}
-        ~game_object() = default;
-        
-        game_object(game_object const &)            = delete;
-        game_object &operator=(game_object const &) = delete;
-        game_object(game_object &&)                 = default;
-        game_object &operator=(game_object &&)      = default;
+        game_object(component_store &components, id_t id) : components_{&components}, id_{id} {}
 
         [[nodiscard]] auto id() const -> id_t { return id_; }
-        [[nodiscard]] auto name() const -> std::string { return name_; }
-        [[nodiscard]] auto material() const -> material const & { return material_; }
+        [[nodiscard]] auto name() const -> std::string const & { return components_->names().get(id_); }
+        [[nodiscard]] auto transform() const -> transform_component & { return components_->transforms().get(id_); }
+
+        // The transform becomes relative to the parent's, the object moves with it
+        void set_parent(game_object const &parent) const { components_->set_parent(id_, parent.id()); }
+        void remove_parent() const { components_->remove_parent(id_); }
 
-        void set_material(float r, float g, float b, float metallic, float roughness)
+        // nullptr until a model is set
+        [[nodiscard]] auto mesh() const -> mesh_component * { return components_->meshes().find(id_); }
+
+        void set_model(std::shared_ptr<model> model) const
         {
-            material_ = dae::material{glm::vec3{r, g, b}, metallic, roughness};
+            if (auto *mesh_ptr = mesh())
+            {
+                mesh_ptr->model = std::move(model);
+                return;
+            }
+            components_->meshes().emplace(id_, std::move(model));
         }
 
-    public:
-        std::unique_ptr<model> model     = {};
-        glm::vec3              color     = {};
-        transform_component    transform = {};
+        void set_material(float r, float g, float b, float metallic, float roughness) const
+        {
+            material_component const value{glm::vec3{r, g, b}, metallic, roughness};
+            if (auto *material_ptr = components_->materials().find(id_))
+            {
+                *material_ptr = value;
+                return;
+            }
+            components_->materials().emplace(id_, value);
+        }
 
-        std::unique_ptr<point_light_component> point_light = nullptr;
-        bool use_texture = false;
+        auto add_point_light(glm::vec3 color, float light_intensity) const -> point_light_component &
+        {
+            return components_->point_lights().emplace(id_, color, light_intensity);
+        }
 
     private:
-        id_t          id_;
-        std::string   name_;
-        dae::material material_ = {};
-
-        static id_t next_id_;
+        component_store *components_;
+        id_t             id_;
     };
 }
@@ -0,0 +1,176 @@
+﻿#include "mesh_cache.h"
+
+// Standard includes
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace dae
+{
+    namespace
+    {
+        constexpr uint64_t section_alignment = 16;
+
+        auto align_up(uint64_t value, uint64_t alignment) -> uint64_t
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        auto source_stamp(std::string const &source_path, uint64_t &size, int64_t &write_time) -> bool
+        {
+            std::error_code error{};
+            size = std::filesystem::file_size(source_path, error);
+            if (error)
+            {
+                return false;
+            }
+
+            write_time = std::filesystem::last_write_time(source_path, error).time_since_epoch().count();
+            return not error;
+        }
+    }
+
+    mesh_cache::mesh_cache(mapped_file &&file, header const *header)
+        : file_{std::move(file)}
+        , header_{header}
+    {
+    }
+
+    auto mesh_cache::cache_path(std::string const &source_path) -> std::string
+    {
+        return source_path + ".mesh";
+    }
+
+    auto mesh_cache::open(std::string const &source_path, model::builder const &settings) -> std::unique_ptr<mesh_cache>
+    {
+        uint64_t source_size       = 0;
+        int64_t  source_write_time = 0;
+        if (not source_stamp(source_path, source_size, source_write_time))
+        {
+            return nullptr;
+        }
+
+        mapped_file file{cache_path(source_path)};
+        if (not file.is_open() or file.size() < sizeof(header))
+        {
+            return nullptr;
+        }
+
+        auto const *cache_header = reinterpret_cast<header const *>(file.data());
+        if (cache_header->magic != magic or
+            cache_header->version != version or
+            cache_header->vertex_stride != sizeof(model::vertex) or
+            cache_header->weld_epsilon != settings.weld_epsilon or
+            cache_header->optimization != static_cast<uint32_t>(settings.optimization) or
+            cache_header->max_lod_count != settings.max_lod_count or
+            cache_header->source_size != source_size or
+            cache_header->source_write_time != source_write_time)
+        {
+            return nullptr;
+        }
+
+        uint64_t const vertex_end = cache_header->vertex_offset + uint64_t{cache_header->vertex_count} * sizeof(model::vertex);
+        uint64_t const index_end  = cache_header->index_offset + uint64_t{cache_header->index_count} * sizeof(uint32_t);
+        uint64_t const lod_end     = cache_header->lod_offset + uint64_t{cache_header->lod_count} * sizeof(model::lod);
+        uint64_t const meshlet_end = cache_header->meshlet_offset + uint64_t{cache_header->meshlet_count} * sizeof(model::meshlet);
+        if (vertex_end > file.size() or index_end > file.size() or lod_end > file.size() or meshlet_end > file.size() or
+            cache_header->vertex_offset % alignof(model::vertex) != 0 or
+            cache_header->index_offset % alignof(uint32_t) != 0 or
+            cache_header->lod_offset % alignof(model::lod) != 0 or
+            cache_header->meshlet_offset % alignof(model::meshlet) != 0)
+        {
+            return nullptr;
+        }
+
+        return std::unique_ptr<mesh_cache>(new mesh_cache{std::move(file), cache_header});
+    }
+
+    auto mesh_cache::write(std::string const &source_path, model::builder const &builder) -> bool
+    {
+        header cache_header{};
+        if (not source_stamp(source_path, cache_header.source_size, cache_header.source_write_time))
+        {
+            return false;
+        }
+
+        cache_header.vertex_count    = static_cast<uint32_t>(builder.vertices.size());
+        cache_header.index_count     = static_cast<uint32_t>(builder.indices.size());
+        cache_header.lod_count       = static_cast<uint32_t>(builder.lods.size());
+        cache_header.meshlet_count   = static_cast<uint32_t>(builder.meshlets.size());
+        cache_header.vertex_offset   = align_up(sizeof(header), section_alignment);
+        cache_header.index_offset    = align_up(cache_header.vertex_offset + builder.vertices.size() * sizeof(model::vertex), section_alignment);
+        cache_header.lod_offset      = align_up(cache_header.index_offset + builder.indices.size() * sizeof(uint32_t), section_alignment);
+        cache_header.meshlet_offset  = align_up(cache_header.lod_offset + builder.lods.size() * sizeof(model::lod), section_alignment);
+        cache_header.weld_epsilon    = builder.weld_epsilon;
+        cache_header.optimization    = static_cast<uint32_t>(builder.optimization);
+        cache_header.max_lod_count   = builder.max_lod_count;
+        cache_header.bounds          = builder.bounds;
+        cache_header.bounding_sphere = builder.bounding_sphere;
+
+        // Write to a temporary file first so a crash never leaves a truncated cache behind
+        std::string const path      = cache_path(source_path);
+        std::string const temp_path = path + ".tmp";
+        {
+            std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+            if (not file.is_open())
+            {
+                return false;
+            }
+
+            auto const pad_to = [&file](uint64_t offset)
+            {
+                static constexpr char zeros[section_alignment] = {};
+                auto const position = static_cast<uint64_t>(file.tellp());
+                file.write(zeros, static_cast<std::streamsize>(offset - position));
+            };
+
+            file.write(reinterpret_cast<char const *>(&cache_header), sizeof(header));
+            pad_to(cache_header.vertex_offset);
+            file.write(reinterpret_cast<char const *>(builder.vertices.data()), static_cast<std::streamsize>(builder.vertices.size() * sizeof(model::vertex)));
+            pad_to(cache_header.index_offset);
+            file.write(reinterpret_cast<char const *>(builder.indices.data()), static_cast<std::streamsize>(builder.indices.size() * sizeof(uint32_t)));
+            pad_to(cache_header.lod_offset);
+            file.write(reinterpret_cast<char const *>(builder.lods.data()), static_cast<std::streamsize>(builder.lods.size() * sizeof(model::lod)));
+            pad_to(cache_header.meshlet_offset);
+            file.write(reinterpret_cast<char const *>(builder.meshlets.data()), static_cast<std::streamsize>(builder.meshlets.size() * sizeof(model::meshlet)));
+
+            if (not file.good())
+            {
+                return false;
+            }
+        }
+
+        std::error_code error{};
+        std::filesystem::rename(temp_path, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+        return true;
+    }
+
+    auto mesh_cache::vertices() const -> std::span<model::vertex const>
+    {
+        auto const *first = reinterpret_cast<model::vertex const *>(file_.data() + header_->vertex_offset);
+        return {first, header_->vertex_count};
+    }
+
+    auto mesh_cache::indices() const -> std::span<uint32_t const>
+    {
+        auto const *first = reinterpret_cast<uint32_t const *>(file_.data() + header_->index_offset);
+        return {first, header_->index_count};
+    }
+
+    auto mesh_cache::lods() const -> std::span<model::lod const>
+    {
+        auto const *first = reinterpret_cast<model::lod const *>(file_.data() + header_->lod_offset);
+        return {first, header_->lod_count};
+    }
+
+    auto mesh_cache::meshlets() const -> std::span<model::meshlet const>
+    {
+        auto const *first = reinterpret_cast<model::meshlet const *>(file_.data() + header_->meshlet_offset);
+        return {first, header_->meshlet_count};
+    }
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+#include "src/utility/mapped_file.h"
+
+// Standard includes
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace dae
+{
+    // Binary snapshot of a loaded model::builder, stored next to the source file.
+    // Warm loads memory-map the cache and hand its arrays straight to the upload path.
+    class mesh_cache final
+    {
+    public:
+        static constexpr uint32_t magic   = 0x4853454D; // "MESH"
+        static constexpr uint32_t version = 6;
+
+        struct header
+        {
+            uint32_t      magic             = mesh_cache::magic;
+            uint32_t      version           = mesh_cache::version;
+            uint32_t      vertex_stride     = sizeof(model::vertex);
+            uint32_t      vertex_count      = 0;
+            uint32_t      index_count       = 0;
+            uint32_t      lod_count         = 0;
+            uint32_t      meshlet_count     = 0;
+            float         weld_epsilon      = 0.0f;
+            uint32_t      optimization      = 0;
+            uint32_t      max_lod_count     = 0;
+            uint64_t      vertex_offset     = 0;
+            uint64_t      index_offset      = 0;
+            uint64_t      lod_offset        = 0;
+            uint64_t      meshlet_offset    = 0;
+            uint64_t      source_size       = 0;
+            int64_t       source_write_time = 0;
+            model::aabb   bounds            = {};
+            model::sphere bounding_sphere   = {};
+        };
+
+        ~mesh_cache() = default;
+
+        mesh_cache(mesh_cache const &)            = delete;
+        mesh_cache(mesh_cache &&)                 = delete;
+        mesh_cache &operator=(mesh_cache const &) = delete;
+        mesh_cache &operator=(mesh_cache &&)      = delete;
+
+        // Returns nullptr when the cache is missing, stale, written by another version or with other builder settings
+        static auto open(std::string const &source_path, model::builder const &settings) -> std::unique_ptr<mesh_cache>;
+        static auto write(std::string const &source_path, model::builder const &builder) -> bool;
+        static auto cache_path(std::string const &source_path) -> std::string;
+
+        [[nodiscard]] auto vertices() const -> std::span<model::vertex const>;
+        [[nodiscard]] auto indices() const -> std::span<uint32_t const>;
+        [[nodiscard]] auto lods() const -> std::span<model::lod const>;
+        [[nodiscard]] auto meshlets() const -> std::span<model::meshlet const>;
+        [[nodiscard]] auto bounds() const -> model::aabb const & { return header_->bounds; }
+        [[nodiscard]] auto bounding_sphere() const -> model::sphere const & { return header_->bounding_sphere; }
+
+    private:
+        mesh_cache(mapped_file &&file, header const *header);
+
+        mapped_file   file_   = {};
+        header const *header_ = nullptr;
+    };
+}
@@ -0,0 +1,398 @@
+﻿#include "mesh_optimizer.h"
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace dae
+{
+    namespace
+    {
+        // Forsyth's scoring constants, from "Linear-Speed Vertex Cache Optimisation"
+        constexpr uint32_t lru_cache_size      = 32;
+        constexpr float    cache_decay_power   = 1.5f;
+        constexpr float    last_triangle_score = 0.75f;
+        constexpr float    valence_boost_scale = 2.0f;
+        constexpr float    valence_boost_power = 0.5f;
+        constexpr uint32_t max_table_valence   = 64;
+
+        struct score_tables
+        {
+            std::array<float, lru_cache_size>        cache   = {};
+            std::array<float, max_table_valence + 1> valence = {};
+
+            score_tables()
+            {
+                for (uint32_t position = 0; position < lru_cache_size; ++position)
+                {
+                    cache[position] = position < 3
+                        ? last_triangle_score
+                        : std::pow(1.0f - static_cast<float>(position - 3) / (lru_cache_size - 3), cache_decay_power);
+                }
+
+                for (uint32_t remaining = 1; remaining <= max_table_valence; ++remaining)
+                {
+                    valence[remaining] = valence_boost_scale * std::pow(static_cast<float>(remaining), -valence_boost_power);
+                }
+            }
+
+            [[nodiscard]] auto score(int32_t cache_position, uint32_t remaining_triangles) const -> float
+            {
+                if (remaining_triangles == 0)
+                {
+                    return -1.0f; // no triangles left to emit, never picked
+                }
+
+                float const cache_score   = cache_position >= 0 ? cache[cache_position] : 0.0f;
+                float const valence_score = remaining_triangles <= max_table_valence
+                    ? valence[remaining_triangles]
+                    : valence_boost_scale * std::pow(static_cast<float>(remaining_triangles), -valence_boost_power);
+                return cache_score + valence_score;
+            }
+        };
+
+        // FIFO post-transform cache using timestamps, a vertex is resident while fewer than size misses happened since it was loaded
+        class fifo_cache final
+        {
+        public:
+            fifo_cache(size_t vertex_count, uint32_t size)
+                : timestamps_(vertex_count, 0)
+                , size_{size}
+                , time_{size + 1}
+            {
+            }
+
+            // Returns 1 on a miss, 0 on a hit
+            auto access(uint32_t vertex) -> uint32_t
+            {
+                if (time_ - timestamps_[vertex] <= size_)
+                {
+                    return 0;
+                }
+
+                timestamps_[vertex] = time_++;
+                return 1;
+            }
+
+            auto access_triangle(uint32_t const *corners) -> uint32_t
+            {
+                return access(corners[0]) + access(corners[1]) + access(corners[2]);
+            }
+
+            void flush()
+            {
+                time_ += size_ + 1;
+            }
+
+        private:
+            std::vector<uint64_t> timestamps_;
+            uint64_t              size_;
+            uint64_t              time_;
+        };
+    }
+
+    void mesh_optimizer::optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count)
+    {
+        size_t const triangle_count = indices.size() / 3;
+        if (triangle_count == 0)
+        {
+            return;
+        }
+
+        static score_tables const tables{};
+
+        // Vertex to triangle adjacency, the live triangles of vertex v are adjacency[offsets[v], offsets[v] + remaining[v])
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        for (uint32_t const index : indices)
+        {
+            ++offsets[index + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<uint32_t> remaining(vertex_count, 0);
+        std::vector<uint32_t> adjacency(indices.size());
+        for (size_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t const vertex = indices[triangle * 3 + corner];
+                adjacency[offsets[vertex] + remaining[vertex]++] = static_cast<uint32_t>(triangle);
+            }
+        }
+
+        std::vector<int32_t> cache_position(vertex_count, -1);
+        std::vector<float>   vertex_score(vertex_count);
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            vertex_score[vertex] = tables.score(-1, remaining[vertex]);
+        }
+
+        std::vector<float>   triangle_score(triangle_count);
+        std::vector<uint8_t> emitted(triangle_count, 0);
+        for (size_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            uint32_t const *corners = &indices[triangle * 3];
+            triangle_score[triangle] = vertex_score[corners[0]] + vertex_score[corners[1]] + vertex_score[corners[2]];
+        }
+
+        std::vector<uint32_t> output{};
+        output.reserve(triangle_count * 3);
+
+        std::array<uint32_t, lru_cache_size + 3> cache{};
+        std::array<uint32_t, lru_cache_size + 3> next_cache{};
+        size_t cache_count = 0;
+
+        size_t  cursor = 0;
+        int64_t best   = std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin();
+
+        for (size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count)
+        {
+            if (best < 0)
+            {
+                // Nothing adjacent to the cache is left, continue with the next unemitted triangle in input order
+                while (emitted[cursor])
+                {
+                    ++cursor;
+                }
+                best = static_cast<int64_t>(cursor);
+            }
+
+            uint32_t const corners[3] = {indices[best * 3 + 0], indices[best * 3 + 1], indices[best * 3 + 2]};
+            output.insert(output.end(), corners, corners + 3);
+            emitted[best] = 1;
+
+            for (uint32_t const vertex : corners)
+            {
+                // Swap the triangle out of the vertex's live range
+                uint32_t *first = &adjacency[offsets[vertex]];
+                uint32_t *last  = first + remaining[vertex];
+                std::iter_swap(std::find(first, last, static_cast<uint32_t>(best)), last - 1);
+                --remaining[vertex];
+            }
+
+            // The emitted corners move to the front, the rest of the cache shifts back
+            size_t next_count = 0;
+            for (uint32_t const vertex : corners)
+            {
+                if (std::find(next_cache.begin(), next_cache.begin() + next_count, vertex) == next_cache.begin() + next_count)
+                {
+                    next_cache[next_count++] = vertex;
+                }
+            }
+            for (size_t slot = 0; slot < cache_count; ++slot)
+            {
+                uint32_t const vertex = cache[slot];
+                if (vertex != corners[0] and vertex != corners[1] and vertex != corners[2])
+                {
+                    next_cache[next_count++] = vertex;
+                }
+            }
+
+            // Rescore every vertex that was or is in the cache, propagating the change to its live triangles
+            for (size_t slot = 0; slot < next_count; ++slot)
+            {
+                uint32_t const vertex   = next_cache[slot];
+                int32_t const  position = slot < lru_cache_size ? static_cast<int32_t>(slot) : -1;
+                cache_position[vertex] = position;
+
+                float const score = tables.score(position, remaining[vertex]);
+                float const delta = score - vertex_score[vertex];
+                vertex_score[vertex] = score;
+
+                for (uint32_t live = 0; live < remaining[vertex]; ++live)
+                {
+                    triangle_score[adjacency[offsets[vertex] + live]] += delta;
+                }
+            }
+
+            cache_count = std::min<size_t>(next_count, lru_cache_size);
+            std::copy_n(next_cache.begin(), cache_count, cache.begin());
+
+            // Next triangle is the best one touching the cache
+            best = -1;
+            float best_score = -1.0f;
+            for (size_t slot = 0; slot < cache_count; ++slot)
+            {
+                uint32_t const vertex = cache[slot];
+                for (uint32_t live = 0; live < remaining[vertex]; ++live)
+                {
+                    uint32_t const triangle = adjacency[offsets[vertex] + live];
+                    if (triangle_score[triangle] > best_score)
+                    {
+                        best_score = triangle_score[triangle];
+                        best       = triangle;
+                    }
+                }
+            }
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    void mesh_optimizer::optimize_overdraw(std::span<uint32_t> indices, std::span<model::vertex const> vertices, float threshold)
+    {
+        size_t const triangle_count = indices.size() / 3;
+        if (triangle_count == 0)
+        {
+            return;
+        }
+
+        // Hard boundaries sit where the cache order restarted, every corner of the triangle missed
+        std::vector<size_t> hard_starts{};
+        {
+            fifo_cache cache{vertices.size(), fifo_cache_size};
+            for (size_t triangle = 0; triangle < triangle_count; ++triangle)
+            {
+                if (cache.access_triangle(&indices[triangle * 3]) == 3)
+                {
+                    hard_starts.push_back(triangle);
+                }
+            }
+            if (hard_starts.empty() or hard_starts[0] != 0)
+            {
+                hard_starts.insert(hard_starts.begin(), 0);
+            }
+            hard_starts.push_back(triangle_count);
+        }
+
+        // Soft boundaries split a hard cluster as soon as the part so far, drawn from a cold cache,
+        // is within threshold of the whole cluster's ACMR
+        std::vector<size_t> cluster_starts{};
+        {
+            fifo_cache cache{vertices.size(), fifo_cache_size};
+            for (size_t hard = 0; hard + 1 < hard_starts.size(); ++hard)
+            {
+                size_t const begin = hard_starts[hard];
+                size_t const end   = hard_starts[hard + 1];
+
+                cache.flush();
+                uint32_t cluster_misses = 0;
+                for (size_t triangle = begin; triangle < end; ++triangle)
+                {
+                    cluster_misses += cache.access_triangle(&indices[triangle * 3]);
+                }
+                float const target_acmr = static_cast<float>(cluster_misses) / static_cast<float>(end - begin) * threshold;
+
+                cache.flush();
+                cluster_starts.push_back(begin);
+                size_t   soft_begin  = begin;
+                uint32_t soft_misses = 0;
+                for (size_t triangle = begin; triangle + 1 < end; ++triangle)
+                {
+                    soft_misses += cache.access_triangle(&indices[triangle * 3]);
+                    if (static_cast<float>(soft_misses) <= target_acmr * static_cast<float>(triangle + 1 - soft_begin))
+                    {
+                        cache.flush();
+                        cluster_starts.push_back(triangle + 1);
+                        soft_begin  = triangle + 1;
+                        soft_misses = 0;
+                    }
+                }
+            }
+            cluster_starts.push_back(triangle_count);
+        }
+
+        size_t const cluster_count = cluster_starts.size() - 1;
+
+        // Area weighted centroids and normals, the cross product's length is twice the triangle area
+        std::vector<glm::vec3> cluster_centroids(cluster_count, glm::vec3{0.0f});
+        std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3{0.0f});
+        glm::vec3 mesh_centroid{0.0f};
+        float     mesh_area = 0.0f;
+
+        for (size_t cluster = 0; cluster < cluster_count; ++cluster)
+        {
+            float cluster_area = 0.0f;
+            for (size_t triangle = cluster_starts[cluster]; triangle < cluster_starts[cluster + 1]; ++triangle)
+            {
+                glm::vec3 const &p0 = vertices[indices[triangle * 3 + 0]].position;
+                glm::vec3 const &p1 = vertices[indices[triangle * 3 + 1]].position;
+                glm::vec3 const &p2 = vertices[indices[triangle * 3 + 2]].position;
+
+                glm::vec3 const normal = glm::cross(p1 - p0, p2 - p0);
+                float const     area   = glm::length(normal);
+
+                cluster_centroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+                cluster_normals[cluster]   += normal;
+                cluster_area               += area;
+            }
+
+            mesh_centroid += cluster_centroids[cluster];
+            mesh_area     += cluster_area;
+            cluster_centroids[cluster] = cluster_area > 0.0f ? cluster_centroids[cluster] / cluster_area : glm::vec3{0.0f};
+        }
+        mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : glm::vec3{0.0f};
+
+        std::vector<float> sort_keys(cluster_count);
+        for (size_t cluster = 0; cluster < cluster_count; ++cluster)
+        {
+            float const length = glm::length(cluster_normals[cluster]);
+            sort_keys[cluster] = length > 0.0f ? glm::dot(cluster_centroids[cluster] - mesh_centroid, cluster_normals[cluster] / length) : 0.0f;
+        }
+
+        std::vector<size_t> cluster_order(cluster_count);
+        std::iota(cluster_order.begin(), cluster_order.end(), size_t{0});
+        std::stable_sort(cluster_order.begin(), cluster_order.end(), [&sort_keys](size_t lhs, size_t rhs) { return sort_keys[lhs] > sort_keys[rhs]; });
+
+        std::vector<uint32_t> output{};
+        output.reserve(indices.size());
+        for (size_t const cluster : cluster_order)
+        {
+            output.insert(output.end(), indices.begin() + cluster_starts[cluster] * 3, indices.begin() + cluster_starts[cluster + 1] * 3);
+        }
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    void mesh_optimizer::optimize_vertex_fetch(std::vector<model::vertex> &vertices, std::span<uint32_t> indices)
+    {
+        constexpr uint32_t unused = UINT32_MAX;
+
+        std::vector<uint32_t>      remap(vertices.size(), unused);
+        std::vector<model::vertex> fetch_order{};
+        fetch_order.reserve(vertices.size());
+
+        for (uint32_t &index : indices)
+        {
+            if (remap[index] == unused)
+            {
+                remap[index] = static_cast<uint32_t>(fetch_order.size());
+                fetch_order.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        vertices = std::move(fetch_order);
+    }
+
+    auto mesh_optimizer::analyze_vertex_cache(std::span<uint32_t const> indices, size_t vertex_count, uint32_t cache_size) -> cache_statistics
+    {
+        size_t const triangle_count = indices.size() / 3;
+        if (triangle_count == 0)
+        {
+            return {};
+        }
+
+        fifo_cache           cache{vertex_count, cache_size};
+        std::vector<uint8_t> referenced(vertex_count, 0);
+        size_t               misses           = 0;
+        size_t               referenced_count = 0;
+
+        for (size_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            misses += cache.access_triangle(&indices[triangle * 3]);
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                uint32_t const vertex = indices[triangle * 3 + corner];
+                referenced_count += referenced[vertex] == 0;
+                referenced[vertex] = 1;
+            }
+        }
+
+        return {
+            .acmr = static_cast<float>(misses) / static_cast<float>(triangle_count),
+            .atvr = static_cast<float>(misses) / static_cast<float>(referenced_count)
+        };
+    }
+}
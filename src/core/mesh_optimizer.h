@@ -0,0 +1,39 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+
+// Standard includes
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dae
+{
+    // Post-load reordering of a deduplicated mesh. Triangles are sorted for post-transform cache reuse
+    // (Forsyth's linear-speed algorithm), optionally regrouped so outward facing clusters draw first,
+    // and vertices are finally renumbered in first-use order so fetches walk the vertex buffer linearly.
+    class mesh_optimizer final
+    {
+    public:
+        struct cache_statistics
+        {
+            float acmr = 0.0f; // transformed vertices per triangle, 3 is the worst case, ~0.5 the best for grids
+            float atvr = 0.0f; // transformed vertices per referenced vertex, 1 is the best case
+        };
+
+        // FIFO size used for the statistics and overdraw clustering, close to what current GPUs behave like
+        static constexpr uint32_t fifo_cache_size = 16;
+
+        static void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count);
+
+        // Splits the cache-optimized order into clusters whose ACMR stays within threshold of the original,
+        // then sorts them front to back by how far each cluster faces away from the mesh centroid
+        static void optimize_overdraw(std::span<uint32_t> indices, std::span<model::vertex const> vertices, float threshold = 1.05f);
+
+        // Drops unreferenced vertices and rewrites the indices to match the new order
+        static void optimize_vertex_fetch(std::vector<model::vertex> &vertices, std::span<uint32_t> indices);
+
+        static auto analyze_vertex_cache(std::span<uint32_t const> indices, size_t vertex_count, uint32_t cache_size = fifo_cache_size) -> cache_statistics;
+    };
+}
@@ -0,0 +1,111 @@
+﻿#include "mesh_registry.h"
+
+// Project includes
+#include "src/engine/engine.h"
+#include "src/utility/mapped_file.h"
+
+// Standard includes
+#include <cstring>
+#include <stdexcept>
+
+#if defined(CMAKE_BUILD)
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../../../"
+#endif
+#else
+#ifndef ENGINE_DIR
+#define ENGINE_DIR ""
+#endif
+#endif
+
+namespace dae
+{
+    auto mesh_registry::acquire(std::string const &file_path, model::vertex_layout layout) -> std::shared_ptr<model>
+    {
+        auto const path_it = path_hashes_.find({file_path, layout});
+        uint64_t const hash = path_it != path_hashes_.end() ? path_it->second : content_hash(file_path);
+        return acquire(file_path, layout, hash, [&] { return std::shared_ptr<model>{model::create_model(file_path, layout)}; });
+    }
+
+    auto mesh_registry::acquire(
+        std::string const &file_path,
+        model::vertex_layout layout,
+        uint64_t hash,
+        std::function<std::shared_ptr<model>()> const &create) -> std::shared_ptr<model>
+    {
+        ++requests_;
+        path_hashes_.emplace(std::pair{file_path, layout}, hash);
+
+        std::weak_ptr<model> &entry = models_[{hash, layout}];
+        if (auto resident = entry.lock())
+        {
+            ++hits_;
+            return resident;
+        }
+
+        std::shared_ptr<model> loaded = create();
+        entry = loaded;
+        ++loads_;
+        return loaded;
+    }
+
+    auto mesh_registry::find(std::string const &file_path, model::vertex_layout layout) -> std::shared_ptr<model>
+    {
+        auto const path_it = path_hashes_.find({file_path, layout});
+        if (path_it == path_hashes_.end())
+        {
+            return nullptr;
+        }
+
+        auto const model_it = models_.find({path_it->second, layout});
+        std::shared_ptr<model> resident = model_it != models_.end() ? model_it->second.lock() : nullptr;
+        if (resident)
+        {
+            ++requests_;
+            ++hits_;
+        }
+        return resident;
+    }
+
+    auto mesh_registry::stats() const -> statistics
+    {
+        statistics result{requests_, hits_, loads_};
+        for (auto const &[key, entry] : models_)
+        {
+            if (auto const resident = entry.lock())
+            {
+                ++result.resident_models;
+                result.resident_bytes += resident->resident_bytes();
+            }
+        }
+        return result;
+    }
+
+    // 64 bits at a time with a splitmix style finalizer, the same mixing the vertex dedup table uses
+    auto mesh_registry::content_hash(std::string const &file_path) -> uint64_t
+    {
+        mapped_file const file{ENGINE_DIR + engine::data_path + file_path};
+        if (not file.is_open())
+        {
+            throw std::runtime_error{"Failed to open model file " + file_path};
+        }
+
+        uint64_t hash_value = 0x9E3779B97F4A7C15ull ^ file.size();
+        size_t   offset     = 0;
+        for (; offset + sizeof(uint64_t) <= file.size(); offset += sizeof(uint64_t))
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, file.data() + offset, sizeof(word));
+            hash_value = (hash_value ^ word) * 0xBF58476D1CE4E5B9ull;
+            hash_value ^= hash_value >> 31;
+        }
+
+        uint64_t tail = 0;
+        std::memcpy(&tail, file.data() + offset, file.size() - offset);
+        hash_value = (hash_value ^ tail) * 0x94D049BB133111EBull;
+        hash_value ^= hash_value >> 29;
+        hash_value *= 0xBF58476D1CE4E5B9ull;
+        hash_value ^= hash_value >> 32;
+        return hash_value;
+    }
+}
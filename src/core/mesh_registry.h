@@ -0,0 +1,68 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+#include "src/utility/singleton.h"
+
+// Standard includes
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace dae
+{
+    // Hands out shared models so every path, and every file with the same contents, is parsed and uploaded once.
+    // The registry only keeps weak references, a model is freed with the last game object using it.
+    class mesh_registry final : public singleton<mesh_registry>
+    {
+    public:
+        struct statistics
+        {
+            uint64_t     requests        = 0;
+            uint64_t     hits            = 0; // served by an already resident model, by path or by content
+            uint64_t     loads           = 0;
+            uint64_t     resident_models = 0;
+            VkDeviceSize resident_bytes  = 0;
+        };
+
+        ~mesh_registry() override = default;
+
+        mesh_registry(mesh_registry const &)            = delete;
+        mesh_registry(mesh_registry &&)                 = delete;
+        mesh_registry &operator=(mesh_registry const &) = delete;
+        mesh_registry &operator=(mesh_registry &&)      = delete;
+
+        // Same path and layout as model::create_model
+        auto acquire(std::string const &file_path, model::vertex_layout layout = model::vertex_layout::full) -> std::shared_ptr<model>;
+
+        // Streamed counterpart, the file was hashed off the render thread and create only runs when nothing matches
+        auto acquire(
+            std::string const &file_path,
+            model::vertex_layout layout,
+            uint64_t hash,
+            std::function<std::shared_ptr<model>()> const &create) -> std::shared_ptr<model>;
+
+        // Model already resident for a path seen before, nullptr when it still has to be loaded
+        auto find(std::string const &file_path, model::vertex_layout layout = model::vertex_layout::full) -> std::shared_ptr<model>;
+
+        [[nodiscard]] auto stats() const -> statistics;
+
+        // Thread safe, takes the path relative to the data directory
+        static auto content_hash(std::string const &file_path) -> uint64_t;
+
+    private:
+        friend class singleton<mesh_registry>;
+        mesh_registry() = default;
+
+        // Paths resolve to the hash of their contents when first requested, the files are not expected to change while running
+        std::map<std::pair<std::string, model::vertex_layout>, uint64_t>          path_hashes_ = {};
+        std::map<std::pair<uint64_t, model::vertex_layout>, std::weak_ptr<model>> models_      = {};
+
+        uint64_t requests_ = 0;
+        uint64_t hits_     = 0;
+        uint64_t loads_    = 0;
+    };
+}
@@ -0,0 +1,315 @@
+﻿#include "mesh_simplifier.h"
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace dae
+{
+    namespace
+    {
+        // Symmetric 4x4 matrix summing squared distances to a set of planes
+        struct quadric
+        {
+            double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+            double b2 = 0.0, bc = 0.0, bd = 0.0;
+            double c2 = 0.0, cd = 0.0;
+            double d2 = 0.0;
+
+            void add_plane(glm::dvec3 const &normal, double distance)
+            {
+                a2 += normal.x * normal.x; ab += normal.x * normal.y; ac += normal.x * normal.z; ad += normal.x * distance;
+                b2 += normal.y * normal.y; bc += normal.y * normal.z; bd += normal.y * distance;
+                c2 += normal.z * normal.z; cd += normal.z * distance;
+                d2 += distance * distance;
+            }
+
+            quadric &operator+=(quadric const &other)
+            {
+                a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+                b2 += other.b2; bc += other.bc; bd += other.bd;
+                c2 += other.c2; cd += other.cd;
+                d2 += other.d2;
+                return *this;
+            }
+
+            [[nodiscard]] auto evaluate(glm::dvec3 const &p) const -> double
+            {
+                double const error =
+                    a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x +
+                    b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y +
+                    c2 * p.z * p.z + 2.0 * cd * p.z +
+                    d2;
+                return std::max(error, 0.0);
+            }
+        };
+
+        struct collapse
+        {
+            uint32_t from = 0;
+            uint32_t to   = 0;
+            double   cost = 0.0;
+        };
+
+        auto edge_key(uint32_t lhs, uint32_t rhs) -> uint64_t
+        {
+            return lhs < rhs ? (uint64_t{lhs} << 32 | rhs) : (uint64_t{rhs} << 32 | lhs);
+        }
+    }
+
+    auto mesh_simplifier::simplify(
+        std::span<model::vertex const> vertices,
+        std::span<uint32_t const> indices,
+        size_t target_index_count,
+        float max_error,
+        float &result_error) -> std::vector<uint32_t>
+    {
+        std::vector<uint32_t> result(indices.begin(), indices.end());
+        result_error = 0.0f;
+
+        size_t const vertex_count = vertices.size();
+        if (result.size() <= target_index_count or vertex_count == 0)
+        {
+            return result;
+        }
+
+        // Wedges, vertices that only differ in their attributes, share one position id
+        std::vector<uint32_t> position_id(vertex_count);
+        std::vector<uint8_t>  locked(vertex_count, 0);
+        {
+            std::vector<uint32_t> order(vertex_count);
+            std::iota(order.begin(), order.end(), 0u);
+            auto const position_less = [&vertices](uint32_t lhs, uint32_t rhs)
+            {
+                glm::vec3 const &a = vertices[lhs].position;
+                glm::vec3 const &b = vertices[rhs].position;
+                return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+            };
+            std::sort(order.begin(), order.end(), position_less);
+
+            for (size_t first = 0; first < vertex_count;)
+            {
+                size_t last = first + 1;
+                while (last < vertex_count and vertices[order[last]].position == vertices[order[first]].position)
+                {
+                    ++last;
+                }
+                for (size_t i = first; i < last; ++i)
+                {
+                    position_id[order[i]] = order[first];
+                    locked[order[i]]      = last - first > 1; // attribute seam
+                }
+                first = last;
+            }
+        }
+
+        // Borders and non-manifold edges are the ones not shared by exactly two triangles
+        {
+            std::vector<uint64_t> edges{};
+            edges.reserve(result.size());
+            for (size_t corner = 0; corner < result.size(); corner += 3)
+            {
+                for (size_t edge = 0; edge < 3; ++edge)
+                {
+                    edges.push_back(edge_key(position_id[result[corner + edge]], position_id[result[corner + (edge + 1) % 3]]));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            std::vector<uint8_t> locked_position(vertex_count, 0);
+            for (size_t first = 0; first < edges.size();)
+            {
+                size_t last = first + 1;
+                while (last < edges.size() and edges[last] == edges[first])
+                {
+                    ++last;
+                }
+                if (last - first != 2)
+                {
+                    locked_position[edges[first] >> 32]        = 1;
+                    locked_position[edges[first] & 0xFFFFFFFF] = 1;
+                }
+                first = last;
+            }
+
+            for (size_t vertex = 0; vertex < vertex_count; ++vertex)
+            {
+                locked[vertex] |= locked_position[position_id[vertex]];
+            }
+        }
+
+        // Plane quadrics per position, merged into the surviving position on every collapse
+        std::vector<quadric> quadrics(vertex_count);
+        for (size_t corner = 0; corner < result.size(); corner += 3)
+        {
+            glm::dvec3 const p0 = vertices[result[corner + 0]].position;
+            glm::dvec3 const p1 = vertices[result[corner + 1]].position;
+            glm::dvec3 const p2 = vertices[result[corner + 2]].position;
+
+            glm::dvec3 const normal = glm::cross(p1 - p0, p2 - p0);
+            double const     length = glm::length(normal);
+            if (length <= 0.0)
+            {
+                continue;
+            }
+
+            glm::dvec3 const unit_normal = normal / length;
+            quadric plane{};
+            plane.add_plane(unit_normal, -glm::dot(unit_normal, p0));
+            for (size_t i = 0; i < 3; ++i)
+            {
+                quadrics[position_id[result[corner + i]]] += plane;
+            }
+        }
+
+        double const max_cost = static_cast<double>(max_error) * static_cast<double>(max_error);
+        double       accepted = 0.0;
+
+        std::vector<uint32_t> offsets(vertex_count + 1);
+        std::vector<uint32_t> adjacency{};
+        std::vector<uint32_t> remap(vertex_count);
+        std::vector<uint8_t>  touched(vertex_count);
+        std::vector<collapse> collapses{};
+
+        // Every pass collapses an independent set of edges, then rebuilds adjacency
+        while (result.size() > target_index_count)
+        {
+            size_t const triangle_count = result.size() / 3;
+
+            std::fill(offsets.begin(), offsets.end(), 0u);
+            for (uint32_t const index : result)
+            {
+                ++offsets[index + 1];
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            adjacency.resize(result.size());
+            {
+                std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                for (size_t corner = 0; corner < result.size(); ++corner)
+                {
+                    adjacency[fill[result[corner]]++] = static_cast<uint32_t>(corner / 3);
+                }
+            }
+
+            collapses.clear();
+            for (size_t corner = 0; corner < result.size(); corner += 3)
+            {
+                for (size_t edge = 0; edge < 3; ++edge)
+                {
+                    uint32_t const a = result[corner + edge];
+                    uint32_t const b = result[corner + (edge + 1) % 3];
+                    if (position_id[a] == position_id[b])
+                    {
+                        continue;
+                    }
+
+                    quadric merged = quadrics[position_id[a]];
+                    merged += quadrics[position_id[b]];
+                    if (not locked[a])
+                    {
+                        collapses.push_back({a, b, merged.evaluate(vertices[b].position)});
+                    }
+                    if (not locked[b])
+                    {
+                        collapses.push_back({b, a, merged.evaluate(vertices[a].position)});
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](collapse const &lhs, collapse const &rhs) { return lhs.cost < rhs.cost; });
+
+            std::iota(remap.begin(), remap.end(), 0u);
+            std::fill(touched.begin(), touched.end(), uint8_t{0});
+
+            size_t const removable_triangles = (result.size() - target_index_count) / 3;
+            size_t       removed_triangles   = 0;
+            size_t       collapse_count      = 0;
+
+            for (auto const &candidate : collapses)
+            {
+                if (candidate.cost > max_cost or removed_triangles >= removable_triangles)
+                {
+                    break;
+                }
+
+                uint32_t const from_position = position_id[candidate.from];
+                uint32_t const to_position   = position_id[candidate.to];
+                glm::vec3 const &target      = vertices[candidate.to].position;
+
+                // The fan around from must be untouched this pass and must not flip when from moves onto to
+                bool   valid      = not touched[from_position] and not touched[to_position];
+                size_t degenerate = 0;
+                for (uint32_t fan = offsets[candidate.from]; valid and fan < offsets[candidate.from + 1]; ++fan)
+                {
+                    uint32_t const *triangle = &result[adjacency[fan] * 3];
+
+                    glm::vec3 before[3]{};
+                    glm::vec3 after[3]{};
+                    bool      collapses_away = false;
+                    for (size_t i = 0; i < 3; ++i)
+                    {
+                        valid          = valid and not touched[position_id[triangle[i]]];
+                        collapses_away = collapses_away or position_id[triangle[i]] == to_position;
+                        before[i]      = vertices[triangle[i]].position;
+                        after[i]       = triangle[i] == candidate.from ? target : before[i];
+                    }
+
+                    if (collapses_away)
+                    {
+                        ++degenerate;
+                        continue;
+                    }
+
+                    glm::vec3 const normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    glm::vec3 const normal_after  = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    valid = valid and glm::dot(normal_before, normal_after) > 0.0f;
+                }
+
+                if (not valid)
+                {
+                    continue;
+                }
+
+                remap[candidate.from] = candidate.to;
+                quadrics[to_position] += quadrics[from_position];
+                accepted = std::max(accepted, candidate.cost);
+                removed_triangles += degenerate;
+                ++collapse_count;
+
+                for (uint32_t fan = offsets[candidate.from]; fan < offsets[candidate.from + 1]; ++fan)
+                {
+                    uint32_t const *triangle = &result[adjacency[fan] * 3];
+                    for (size_t i = 0; i < 3; ++i)
+                    {
+                        touched[position_id[triangle[i]]] = 1;
+                    }
+                }
+            }
+
+            if (collapse_count == 0)
+            {
+                break;
+            }
+
+            size_t write = 0;
+            for (size_t triangle = 0; triangle < triangle_count; ++triangle)
+            {
+                uint32_t const i0 = remap[result[triangle * 3 + 0]];
+                uint32_t const i1 = remap[result[triangle * 3 + 1]];
+                uint32_t const i2 = remap[result[triangle * 3 + 2]];
+                if (position_id[i0] == position_id[i1] or position_id[i1] == position_id[i2] or position_id[i0] == position_id[i2])
+                {
+                    continue;
+                }
+
+                result[write++] = i0;
+                result[write++] = i1;
+                result[write++] = i2;
+            }
+            result.resize(write);
+        }
+
+        result_error = static_cast<float>(std::sqrt(accepted));
+        return result;
+    }
+}
@@ -0,0 +1,28 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+
+// Standard includes
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dae
+{
+    // Quadric error metric simplification restricted to existing vertices, so every level can share one vertex buffer.
+    // A vertex only collapses onto a neighbour when it has a single wedge and lies inside the surface:
+    // attribute seams, borders and non-manifold edges stay locked in place.
+    class mesh_simplifier final
+    {
+    public:
+        // Collapses edges cheapest first until target_index_count is reached or the next collapse would exceed max_error,
+        // an object space distance. The error of the last accepted collapse is written to result_error.
+        static auto simplify(
+            std::span<model::vertex const> vertices,
+            std::span<uint32_t const> indices,
+            size_t target_index_count,
+            float max_error,
+            float &result_error) -> std::vector<uint32_t>;
+    };
+}
@@ -0,0 +1,122 @@
+﻿#include "meshlet_builder.h"
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+
+namespace dae
+{
+    auto meshlet_builder::build(std::span<model::vertex const> vertices, std::span<uint32_t const> indices, uint32_t first_index) -> std::vector<model::meshlet>
+    {
+        std::vector<model::meshlet> meshlets{};
+
+        // Which meshlet last referenced each vertex, so counting unique vertices needs no per-meshlet set
+        constexpr uint32_t    none = UINT32_MAX;
+        std::vector<uint32_t> owner(vertices.size(), none);
+
+        auto const count_new_vertices = [&indices, &owner](size_t corner, uint32_t current)
+        {
+            uint32_t new_vertices = 0;
+            for (size_t i = 0; i < 3; ++i)
+            {
+                uint32_t const index = indices[corner + i];
+                bool const     seen  = owner[index] == current or (i > 0 and indices[corner] == index) or (i > 1 and indices[corner + 1] == index);
+                new_vertices += seen ? 0 : 1;
+            }
+            return new_vertices;
+        };
+
+        size_t   begin          = 0;
+        uint32_t vertex_count   = 0;
+        uint32_t triangle_count = 0;
+
+        for (size_t corner = 0; corner < indices.size(); corner += 3)
+        {
+            auto     current      = static_cast<uint32_t>(meshlets.size());
+            uint32_t new_vertices = count_new_vertices(corner, current);
+
+            if (vertex_count + new_vertices > max_vertices or triangle_count == max_triangles)
+            {
+                meshlets.push_back(make_meshlet(vertices, indices.subspan(begin, corner - begin), first_index + static_cast<uint32_t>(begin)));
+                begin          = corner;
+                vertex_count   = 0;
+                triangle_count = 0;
+
+                current      = static_cast<uint32_t>(meshlets.size());
+                new_vertices = count_new_vertices(corner, current);
+            }
+
+            for (size_t i = 0; i < 3; ++i)
+            {
+                owner[indices[corner + i]] = current;
+            }
+            vertex_count += new_vertices;
+            ++triangle_count;
+        }
+
+        if (begin < indices.size())
+        {
+            meshlets.push_back(make_meshlet(vertices, indices.subspan(begin), first_index + static_cast<uint32_t>(begin)));
+        }
+        return meshlets;
+    }
+
+    auto meshlet_builder::make_meshlet(std::span<model::vertex const> vertices, std::span<uint32_t const> indices, uint32_t first_index) -> model::meshlet
+    {
+        model::meshlet meshlet{};
+        meshlet.first_index = first_index;
+        meshlet.index_count = static_cast<uint32_t>(indices.size());
+
+        // Sphere around the box center, loose but cheap and never smaller than the geometry
+        glm::vec3 min = vertices[indices[0]].position;
+        glm::vec3 max = min;
+        for (uint32_t const index : indices)
+        {
+            min = glm::min(min, vertices[index].position);
+            max = glm::max(max, vertices[index].position);
+        }
+
+        meshlet.center = (min + max) * 0.5f;
+        for (uint32_t const index : indices)
+        {
+            meshlet.radius = std::max(meshlet.radius, glm::length(vertices[index].position - meshlet.center));
+        }
+
+        // Normal cone around the mean face normal, its cutoff is the sine of the widest normal's angle to the axis
+        std::vector<glm::vec3> normals{};
+        normals.reserve(indices.size() / 3);
+        glm::vec3 axis{0.0f};
+        for (size_t corner = 0; corner < indices.size(); corner += 3)
+        {
+            glm::vec3 const &p0 = vertices[indices[corner + 0]].position;
+            glm::vec3 const &p1 = vertices[indices[corner + 1]].position;
+            glm::vec3 const &p2 = vertices[indices[corner + 2]].position;
+
+            glm::vec3 const normal = glm::cross(p1 - p0, p2 - p0);
+            float const     length = glm::length(normal);
+            if (length > 0.0f)
+            {
+                normals.push_back(normal / length);
+                axis += normals.back();
+            }
+        }
+
+        float const axis_length = glm::length(axis);
+        if (axis_length <= 0.0f)
+        {
+            return meshlet; // no usable normals, cone_cutoff stays 1 and the backface test never passes
+        }
+
+        meshlet.cone_axis = axis / axis_length;
+
+        float min_dot = 1.0f;
+        for (auto const &normal : normals)
+        {
+            min_dot = std::min(min_dot, glm::dot(normal, meshlet.cone_axis));
+        }
+
+        // Cones close to a hemisphere would almost never cull, skip the test for them
+        meshlet.cone_cutoff = min_dot <= 0.1f ? 1.0f : std::sqrt(1.0f - min_dot * min_dot);
+        return meshlet;
+    }
+}
@@ -0,0 +1,26 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+
+// Standard includes
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dae
+{
+    // Splits an index range into meshlets by scanning it in order, so the input should already be vertex cache optimized.
+    // Every meshlet is a contiguous run of the range, no index reordering is needed.
+    class meshlet_builder final
+    {
+    public:
+        static constexpr uint32_t max_vertices  = 64;
+        static constexpr uint32_t max_triangles = 124;
+
+        static auto build(std::span<model::vertex const> vertices, std::span<uint32_t const> indices, uint32_t first_index) -> std::vector<model::meshlet>;
+
+    private:
+        static auto make_meshlet(std::span<model::vertex const> vertices, std::span<uint32_t const> indices, uint32_t first_index) -> model::meshlet;
+    };
+}
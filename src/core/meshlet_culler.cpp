@@ -0,0 +1,71 @@
+﻿#include "meshlet_culler.h"
+
+// Project includes
+#include "src/engine/camera.h"
+#include "src/utility/frame_arena.h"
+
+// Standard includes
+#include <array>
+
+namespace dae
+{
+    meshlet_culler::meshlet_culler(camera const &camera, bool cull_backfaces)
+        : camera_{camera}
+        , view_projection_{camera.get_projection() * camera.get_view()}
+        , camera_position_{camera.get_position()}
+        , cull_backfaces_{cull_backfaces}
+        , visible_{frame_arena::instance().make_vector<draw_range>()}
+    {
+    }
+
+    auto meshlet_culler::cull(std::span<model::meshlet const> meshlets, glm::mat4 const &model_matrix) -> std::span<draw_range const>
+    {
+        visible_.clear();
+
+        // Object space frustum planes, from the combined clip matrix
+        std::array<glm::vec4, 6> const planes = camera::extract_frustum_planes(view_projection_ * model_matrix);
+
+        // The cone test runs in object space too, mirrored transforms flip the winding so they skip it
+        glm::vec3 const eye       = glm::vec3{glm::inverse(model_matrix) * glm::vec4{camera_position_, 1.0f}};
+        bool const      backfaces = cull_backfaces_ and glm::determinant(glm::mat3{model_matrix}) > 0.0f;
+
+        for (auto const &meshlet : meshlets)
+        {
+            ++statistics_.tested;
+
+            bool outside = false;
+            for (auto const &plane : planes)
+            {
+                outside = outside or glm::dot(glm::vec3{plane}, meshlet.center) + plane.w < -meshlet.radius;
+            }
+            if (outside)
+            {
+                ++statistics_.frustum_culled;
+                continue;
+            }
+
+            if (backfaces)
+            {
+                glm::vec3 const to_center = meshlet.center - eye;
+                if (glm::dot(to_center, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(to_center) + meshlet.radius)
+                {
+                    ++statistics_.backface_culled;
+                    continue;
+                }
+            }
+
+            ++statistics_.drawn;
+            if (not visible_.empty() and visible_.back().first_index + visible_.back().index_count == meshlet.first_index)
+            {
+                visible_.back().index_count += meshlet.index_count;
+            }
+            else
+            {
+                visible_.push_back({meshlet.first_index, meshlet.index_count});
+            }
+        }
+
+        statistics_.draw_calls += visible_.size();
+        return visible_;
+    }
+}
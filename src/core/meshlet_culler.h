@@ -0,0 +1,61 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+
+// Standard includes
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace dae
+{
+    // Forward declarations
+    class camera;
+
+    // CPU reference culling of meshlets against the view frustum and, optionally, their normal cones.
+    // Visible meshlets that are adjacent in the index buffer are merged into a single draw range. The ranges live in
+    // the frame arena, so a culler is made per frame and only from the frame loop.
+    class meshlet_culler final
+    {
+    public:
+        struct statistics
+        {
+            uint64_t tested          = 0;
+            uint64_t frustum_culled  = 0;
+            uint64_t backface_culled = 0;
+            uint64_t drawn           = 0;
+            uint64_t draw_calls      = 0;
+        };
+
+        struct draw_range
+        {
+            uint32_t first_index = 0;
+            uint32_t index_count = 0;
+        };
+
+        // The cone test is only valid for pipelines that cull back faces
+        meshlet_culler(camera const &camera, bool cull_backfaces);
+        ~meshlet_culler() = default;
+
+        meshlet_culler(meshlet_culler const &)            = delete;
+        meshlet_culler(meshlet_culler &&)                 = delete;
+        meshlet_culler &operator=(meshlet_culler const &) = delete;
+        meshlet_culler &operator=(meshlet_culler &&)      = delete;
+
+        // The returned ranges stay valid until the next call
+        auto cull(std::span<model::meshlet const> meshlets, glm::mat4 const &model_matrix) -> std::span<draw_range const>;
+
+        [[nodiscard]] auto view_camera() const -> camera const & { return camera_; }
+        [[nodiscard]] auto stats() const -> statistics const & { return statistics_; }
+
+    private:
+        camera const                &camera_;
+        glm::mat4                    view_projection_ = {};
+        glm::vec3                    camera_position_ = {};
+        bool                         cull_backfaces_  = false;
+        statistics                   statistics_      = {};
+        std::pmr::vector<draw_range> visible_;
+    };
+}
@@ -1,24 +1,35 @@
 ﻿#include "model.h"
 
 // Project includes
+#include "src/core/mesh_cache.h"
+#include "src/core/mesh_optimizer.h"
+#include "src/core/mesh_simplifier.h"
+#include "src/core/meshlet_builder.h"
+#include "src/core/meshlet_culler.h"
+#include "src/core/obj_parser.h"
+#include "src/core/vertex_dedup_table.h"
+#include "src/engine/camera.h"
 #include "src/engine/engine.h"
+#include "src/utility/parallel.h"
 #include "src/utility/utils.h"
-#include "src/vulkan/device.h"
 
 // Standard includes
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <iostream>
-#include <unordered_map>
+#include <limits>
+#include <stdexcept>
+
+// GLM includes
+#include <glm/gtc/packing.hpp>
 
 // TOL includes
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
-// GLM includes
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
 #if defined(CMAKE_BUILD)
 #ifndef ENGINE_DIR
 #define ENGINE_DIR "../../../"
@@ -29,23 +40,112 @@
 #endif
 #endif
 
-namespace std
+namespace dae
 {
-    template<>
-    struct hash<dae::model::vertex>
+    namespace
+    {
+        // Shared by the obj_parser and tinyobj paths, their attribute and index types use the same field names
+        template <typename attributes_t, typename corners_t>
+        void append_corners(model::builder &builder, vertex_dedup_table &unique_vertices, attributes_t const &attrib, corners_t const &corners)
+        {
+            using vertex = model::vertex;
+
+            for (auto const &index : corners)
+            {
+                vertex vertex{};
+
+                if (index.vertex_index >= 0)
+                {
+                    vertex.position = {
+                        attrib.vertices[3 * index.vertex_index + 0],
+                        attrib.vertices[3 * index.vertex_index + 1],
+                        attrib.vertices[3 * index.vertex_index + 2]
+                    };
+
+                    vertex.color = {
+                        attrib.colors[3 * index.vertex_index + 0],
+                        attrib.colors[3 * index.vertex_index + 1],
+                        attrib.colors[3 * index.vertex_index + 2]
+                    };
+                }
+            
+                if (index.normal_index >= 0)
+                {
+                    vertex.normal = {
+                        attrib.normals[3 * index.normal_index + 0],
+                        attrib.normals[3 * index.normal_index + 1],
+                        attrib.normals[3 * index.normal_index + 2]
+                    };
+                }
+            
+                if (index.texcoord_index >= 0)
+                {
+                    vertex.uv = {
+                        attrib.texcoords[2 * index.texcoord_index + 0],
+                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                    };
+                }
+
+                auto const new_index   = static_cast<uint32_t>(builder.vertices.size());
+                auto const found_index = unique_vertices.find_or_insert(vertex, new_index);
+                if (found_index == new_index)
+                {
+                    builder.vertices.push_back(vertex);
+                }
+                builder.indices.push_back(found_index);
+            }
+        }
+
+        // Octahedral mapping of a direction onto [-1, 1]^2, the zero vector maps to +z
+        auto octahedral_encode(glm::vec3 direction) -> glm::vec2
+        {
+            float const length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+            if (length <= 0.0f)
+            {
+                return {0.0f, 0.0f};
+            }
+
+            direction /= length;
+            glm::vec2 encoded{direction.x, direction.y};
+            if (direction.z < 0.0f)
+            {
+                glm::vec2 const sign{encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f};
+                encoded = (1.0f - glm::abs(glm::vec2{encoded.y, encoded.x})) * sign;
+            }
+            return encoded;
+        }
+
+        // unorm16 cannot hold tiling UVs, those models keep the full layout
+        auto uvs_fit_unorm(std::span<model::vertex const> vertices) -> bool
+        {
+            for (auto const &vertex : vertices)
+            {
+                if (vertex.uv.x < 0.0f or vertex.uv.x > 1.0f or vertex.uv.y < 0.0f or vertex.uv.y > 1.0f)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    auto model::vertex_layout_from_string(std::string const &name) -> vertex_layout
     {
-        auto operator()(dae::model::vertex const &vertex) const noexcept -> size_t
+        if (name == "full")
         {
-            size_t seed = 0;
-            dae::hash_combine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-            return seed;
+            return vertex_layout::full;
         }
-    };
-    
-}
+        if (name == "packed")
+        {
+            return vertex_layout::packed;
+        }
+        if (name == "packed_color")
+        {
+            return vertex_layout::packed_color;
+        }
+        throw std::runtime_error{"Unknown vertex layout: " + name};
+    }
 
-namespace dae
-{
     auto model::vertex::get_binding_description() -> std::vector<VkVertexInputBindingDescription>
     {
         std::vector<VkVertexInputBindingDescription> binding_description(1);
@@ -110,127 +210,410 @@ namespace dae
         return position == other.position and color == other.color and normal == other.normal and uv == other.uv;
     }
 
-    void model::builder::load_model(std::string const &file_path)
+    auto model::packed_vertex::get_binding_description(vertex_layout layout) -> std::vector<VkVertexInputBindingDescription>
     {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn, err;
+        assert(layout != vertex_layout::full and "Full vertices use vertex::get_binding_description");
 
+        std::vector<VkVertexInputBindingDescription> binding_description(1);
+        binding_description[0].binding   = 0;
+        binding_description[0].stride    = stride(layout);
+        binding_description[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return binding_description;
+    }
+
+    auto model::packed_vertex::get_attribute_descriptions(vertex_layout layout) -> std::vector<VkVertexInputAttributeDescription>
+    {
+        assert(layout != vertex_layout::full and "Full vertices use vertex::get_attribute_descriptions");
+
+        // Same locations as vertex, the packed shader variants decode the attributes
+        std::vector<VkVertexInputAttributeDescription> attribute_descriptions{
+            {.location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_SFLOAT, .offset = offsetof(packed_vertex, position)},
+            {.location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SNORM,        .offset = offsetof(packed_vertex, normal)},
+            {.location = 3, .binding = 0, .format = VK_FORMAT_R16G16_UNORM,        .offset = offsetof(packed_vertex, uv)},
+            {.location = 4, .binding = 0, .format = VK_FORMAT_R16G16_SNORM,        .offset = offsetof(packed_vertex, tangent)},
+        };
+
+        if (layout == vertex_layout::packed_color)
+        {
+            attribute_descriptions.push_back({.location = 1, .binding = 0, .format = VK_FORMAT_R8G8B8A8_UNORM, .offset = offsetof(packed_vertex, color)});
+        }
+        return attribute_descriptions;
+    }
+
+    auto model::packed_vertex::stride(vertex_layout layout) -> uint32_t
+    {
+        return layout == vertex_layout::packed_color ? sizeof(packed_vertex) : offsetof(packed_vertex, color);
+    }
+
+    void model::builder::load_model(std::string const &file_path)
+    {
         std::string const path = ENGINE_DIR + engine::data_path + file_path;
 
-        if (not tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str()))
+        // Warm start, the cache already holds the final deduplicated arrays
+        if (auto const cache = mesh_cache::open(path, *this))
         {
-            throw std::runtime_error{warn + err};
+            vertices.assign(cache->vertices().begin(), cache->vertices().end());
+            indices.assign(cache->indices().begin(), cache->indices().end());
+            lods.assign(cache->lods().begin(), cache->lods().end());
+            meshlets.assign(cache->meshlets().begin(), cache->meshlets().end());
+            bounds = cache->bounds();
+            bounding_sphere = cache->bounding_sphere();
+            select_index_type();
+            return;
         }
 
+        using namespace std::chrono;
+        auto const start_time = high_resolution_clock::now();
+        auto       parse_time = start_time;
+
         vertices.clear();
         indices.clear();
+        lods.clear();
+        meshlets.clear();
+
+        obj_parser::result obj{};
+        if (obj_parser::parse(path, obj))
+        {
+            parse_time = high_resolution_clock::now();
+
+            vertex_dedup_table unique_vertices{vertices, obj.indices.size(), weld_epsilon};
+            append_corners(*this, unique_vertices, obj, obj.indices);
+        }
+        else
+        {
+            // Polygons with more than 4 corners, let tinyobj's ear clipping handle them
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
 
+            if (not tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str()))
+            {
+                throw std::runtime_error{warn + err};
+            }
+            parse_time = high_resolution_clock::now();
+
+            size_t corner_count = 0;
+            for (auto const &shape : shapes)
+            {
+                corner_count += shape.mesh.indices.size();
+            }
+
+            vertex_dedup_table unique_vertices{vertices, corner_count, weld_epsilon};
+            for (auto const &shape : shapes)
+            {
+                append_corners(*this, unique_vertices, attrib, shape.mesh.indices);
+            }
+        }
+        auto const dedup_time = high_resolution_clock::now();
+
+        generate_tangents();
+        auto const tangent_time = high_resolution_clock::now();
+
+        compute_bounds();
+        generate_lods();
+        auto const lod_time = high_resolution_clock::now();
+
+#ifndef NDEBUG
+        auto const cache_before = mesh_optimizer::analyze_vertex_cache(std::span{indices}.first(lods[0].index_count), vertices.size());
+#endif
+        auto const optimize_start_time = high_resolution_clock::now();
+        optimize();
+        auto const optimize_time = high_resolution_clock::now();
 
-        std::unordered_map<vertex, uint32_t> unique_vertices{};
+        build_meshlets();
+        select_index_type();
+        auto const meshlet_time = high_resolution_clock::now();
 
-        for (auto const &shape : shapes)
+        mesh_cache::write(path, *this);
+
+#ifndef NDEBUG
+        auto const to_ms = [](auto elapsed) { return std::to_string(duration<float, std::milli>(elapsed).count()); };
+        std::cout << YELLOW_TEXT("[Model Load]\n") << ONE_TAB << GREEN_TEXT("" + file_path + "") << '\n'
+                  << TWO_TABS << "parse " << to_ms(parse_time - start_time) << " ms" << '\n'
+                  << TWO_TABS << "dedup " << to_ms(dedup_time - parse_time) << " ms" << '\n'
+                  << TWO_TABS << "tangents " << to_ms(tangent_time - dedup_time) << " ms" << '\n'
+                  << TWO_TABS << "lods " << to_ms(lod_time - tangent_time) << " ms, " << lods.size() << " levels" << '\n'
+                  << TWO_TABS << "optimize " << to_ms(optimize_time - optimize_start_time) << " ms" << '\n'
+                  << TWO_TABS << "meshlets " << to_ms(meshlet_time - optimize_time) << " ms, " << meshlets.size() << " clusters" << '\n'
+                  << TWO_TABS << "indices " << indices.size() << (index_type == VK_INDEX_TYPE_UINT16 ? " x 16 bit" : " x 32 bit") << '\n'
+                  << TWO_TABS << "total " << to_ms(high_resolution_clock::now() - start_time) << " ms" << '\n';
+
+        if (optimization != mesh_optimization::none)
+        {
+            auto const cache_after = mesh_optimizer::analyze_vertex_cache(std::span{indices}.first(lods[0].index_count), vertices.size());
+            std::cout << TWO_TABS << "ACMR " << cache_before.acmr << " -> " << cache_after.acmr
+                      << ", ATVR " << cache_before.atvr << " -> " << cache_after.atvr << '\n';
+        }
+#endif
+    }
+
+    // Per-vertex tangent frames: triangle tangents and bitangents are accumulated, then Gram-Schmidt orthonormalised
+    // against the normal. Handedness is folded into the tangent's sign so cross(normal, tangent) in the shaders
+    // yields the bitangent for mirrored UVs as well.
+    void model::builder::generate_tangents()
+    {
+        struct frame_sum
         {
-            for (auto const &index : shape.mesh.indices)
+            glm::vec3 tangent   = {};
+            glm::vec3 bitangent = {};
+        };
+
+        // Every range accumulates into its own array, summed per vertex afterward, so no atomics are needed. Deduplication
+        // numbers vertices in order of first use, so a range of triangles only touches a narrow span of vertices and
+        // its array covers just that span instead of the whole mesh
+        struct range_sum
+        {
+            uint32_t               first_vertex = 0;
+            std::vector<frame_sum> sums         = {};
+        };
+
+        size_t const triangle_count = indices.size() / 3;
+        std::vector<range_sum> range_sums(parallel_range_count(triangle_count, min_triangles_per_range));
+
+        parallel_for(triangle_count, min_triangles_per_range, [this, &range_sums](size_t range, size_t first, size_t last)
+        {
+            if (first == last)
             {
-                vertex vertex{};
+                return;
+            }
 
-                if (index.vertex_index >= 0)
-                {
-                    vertex.position = {
-                        attrib.vertices[3 * index.vertex_index + 0],
-                        attrib.vertices[3 * index.vertex_index + 1],
-                        attrib.vertices[3 * index.vertex_index + 2]
-                    };
+            auto const [lowest, highest] = std::ranges::minmax(std::span{indices}.subspan(first * 3, (last - first) * 3));
+            range_sums[range].first_vertex = lowest;
+            auto &sums = range_sums[range].sums;
+            sums.assign(size_t{highest} - lowest + 1, {});
 
-                    vertex.color = {
-                        attrib.colors[3 * index.vertex_index + 0],
-                        attrib.colors[3 * index.vertex_index + 1],
-                        attrib.colors[3 * index.vertex_index + 2]
-                    };
+            for (size_t triangle = first; triangle < last; ++triangle)
+            {
+                uint32_t const i0 = indices[triangle * 3 + 0];
+                uint32_t const i1 = indices[triangle * 3 + 1];
+                uint32_t const i2 = indices[triangle * 3 + 2];
+
+                vertex const &v0 = vertices[i0];
+                vertex const &v1 = vertices[i1];
+                vertex const &v2 = vertices[i2];
+
+                glm::vec3 const edge1     = v1.position - v0.position;
+                glm::vec3 const edge2     = v2.position - v0.position;
+                glm::vec2 const delta_uv1 = v1.uv - v0.uv;
+                glm::vec2 const delta_uv2 = v2.uv - v0.uv;
+
+                float const determinant = delta_uv1.x * delta_uv2.y - delta_uv2.x * delta_uv1.y;
+                if (std::abs(determinant) < std::numeric_limits<float>::min())
+                {
+                    continue; // degenerate UV mapping contributes nothing
                 }
-                
-                if (index.normal_index >= 0)
+
+                float const     f         = 1.0f / determinant;
+                glm::vec3 const tangent   = f * (delta_uv2.y * edge1 - delta_uv1.y * edge2);
+                glm::vec3 const bitangent = f * (delta_uv1.x * edge2 - delta_uv2.x * edge1);
+
+                for (uint32_t const index : {i0, i1, i2})
                 {
-                    vertex.normal = {
-                        attrib.normals[3 * index.normal_index + 0],
-                        attrib.normals[3 * index.normal_index + 1],
-                        attrib.normals[3 * index.normal_index + 2]
-                    };
+                    sums[index - lowest].tangent   += tangent;
+                    sums[index - lowest].bitangent += bitangent;
                 }
-                
-                if (index.texcoord_index >= 0)
+            }
+        });
+
+        parallel_for(vertices.size(), min_vertices_per_range, [this, &range_sums](size_t, size_t first, size_t last)
+        {
+            for (size_t index = first; index < last; ++index)
+            {
+                frame_sum sum{};
+                for (auto const &[first_vertex, sums] : range_sums)
                 {
-                    vertex.uv = {
-                        attrib.texcoords[2 * index.texcoord_index + 0],
-                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                    };
+                    if (index >= first_vertex and index - first_vertex < sums.size())
+                    {
+                        sum.tangent   += sums[index - first_vertex].tangent;
+                        sum.bitangent += sums[index - first_vertex].bitangent;
+                    }
                 }
 
-                if (not unique_vertices.contains(vertex))
+                vertex         &vertex = vertices[index];
+                glm::vec3 const normal = glm::dot(vertex.normal, vertex.normal) > 0.0f ? glm::normalize(vertex.normal) : glm::vec3{0.0f, 0.0f, 1.0f};
+
+                glm::vec3 tangent = sum.tangent - normal * glm::dot(normal, sum.tangent);
+                if (glm::dot(tangent, tangent) < std::numeric_limits<float>::min())
                 {
-                    unique_vertices[vertex] = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
+                    // No usable UV gradient, any direction perpendicular to the normal will do
+                    glm::vec3 const axis = std::abs(normal.x) < 0.9f ? glm::vec3{1.0f, 0.0f, 0.0f} : glm::vec3{0.0f, 1.0f, 0.0f};
+                    tangent = axis - normal * glm::dot(normal, axis);
                 }
-                indices.push_back(unique_vertices[vertex]);
+                tangent = glm::normalize(tangent);
+
+                float const handedness = glm::dot(glm::cross(normal, tangent), sum.bitangent) < 0.0f ? -1.0f : 1.0f;
+                vertex.tangent = tangent * handedness;
+            }
+        });
+    }
+
+    // Levels are simplified from the previous one, their errors add up so each stays a bound on the deviation from level 0
+    void model::builder::generate_lods()
+    {
+        lods.assign(1, {0, static_cast<uint32_t>(indices.size()), 0.0f});
+
+        float const radius = glm::length(bounds.max - bounds.min) * 0.5f;
+        std::span<uint32_t const> previous = indices;
+        std::vector<uint32_t> simplified{};
+
+        for (uint32_t level = 1; level < max_lod_count; ++level)
+        {
+            size_t const target_index_count = static_cast<size_t>(static_cast<float>(previous.size() / 3) * lod_reduction) * 3;
+            if (target_index_count / 3 < min_lod_triangles)
+            {
+                break;
             }
 
-            // Cheap tangent calculation
-            for (size_t i = 0; i < indices.size(); i += 3)
+            float error = 0.0f;
+            simplified = mesh_simplifier::simplify(vertices, previous, target_index_count, radius * max_lod_error, error);
+
+            // Locked seams or the error bound stopped the simplifier early, another level would barely differ
+            if (simplified.size() * 10 > previous.size() * 9)
             {
-                vertex &v0 = vertices[indices[i + 0]];
-                vertex &v1 = vertices[indices[i + 1]];
-                vertex &v2 = vertices[indices[i + 2]];
-            
-                glm::vec3 edge1 = v1.position - v0.position;
-                glm::vec3 edge2 = v2.position - v0.position;
-            
-                glm::vec2 uv0 = v0.uv;
-                glm::vec2 uv1 = v1.uv;
-                glm::vec2 uv2 = v2.uv;
-            
-                glm::vec2 delta_uv1 = uv1 - uv0;
-                glm::vec2 delta_uv2 = uv2 - uv0;
+                break;
+            }
 
-                float f = 1.0f / (delta_uv1.x * delta_uv2.y - delta_uv2.x * delta_uv1.y);
+            auto const first_index = static_cast<uint32_t>(indices.size());
+            lods.push_back({first_index, static_cast<uint32_t>(simplified.size()), lods.back().error + error});
+            indices.insert(indices.end(), simplified.begin(), simplified.end());
+            previous = std::span{indices}.subspan(first_index);
+        }
+    }
 
-                glm::vec3 tangent = f * (delta_uv2.y * edge1 - delta_uv1.y * edge2);
-                tangent = glm::normalize(tangent);
+    void model::builder::optimize()
+    {
+        if (optimization == mesh_optimization::none)
+        {
+            return;
+        }
 
-                float sx = delta_uv1.x;
-                float sy = delta_uv2.x;
-                float tx = delta_uv1.y;
-                float ty = delta_uv2.y;
-                
-                float handedness = (sx * ty - sy * tx) > 0.0f ? 1.0f : -1.0f;
-                tangent *= handedness;
-                
-                v0.tangent = tangent;
-                v1.tangent = tangent;
-                v2.tangent = tangent;
+        // Every level is a separate draw, so each is ordered on its own
+        for (auto const &lod : lods)
+        {
+            std::span<uint32_t> const range = std::span{indices}.subspan(lod.first_index, lod.index_count);
+            mesh_optimizer::optimize_vertex_cache(range, vertices.size());
+            if (optimization == mesh_optimization::vertex_cache_and_overdraw)
+            {
+                mesh_optimizer::optimize_overdraw(range, vertices);
             }
         }
+        mesh_optimizer::optimize_vertex_fetch(vertices, indices);
     }
 
-    model::model(builder const &builder)
-        : device_ptr_{&device::instance()}
+    // Runs after optimize so the scan sees cache ordered triangles and the final vertex numbering
+    void model::builder::build_meshlets()
     {
-        create_vertex_buffers(builder.vertices);
-        create_index_buffers(builder.indices);
+        meshlets.clear();
+        if (lods.empty() or lods[0].index_count / 3 < min_meshlet_triangles)
+        {
+            return;
+        }
+
+        meshlets = meshlet_builder::build(vertices, std::span{indices}.subspan(lods[0].first_index, lods[0].index_count), lods[0].first_index);
     }
 
-    model::~model() = default;
+    void model::builder::select_index_type()
+    {
+        index_type = smallest_index_type(vertices.size());
+    }
 
-    auto model::create_model(std::string const &file_path) -> std::unique_ptr<model>
+    void model::builder::compute_bounds()
     {
-        builder builder{};
-        builder.load_model(file_path);
+        if (vertices.empty())
+        {
+            bounds = {};
+            bounding_sphere = {};
+            return;
+        }
+
+        bounds.min = vertices[0].position;
+        bounds.max = vertices[0].position;
+        for (auto const &vertex : vertices)
+        {
+            bounds.min = glm::min(bounds.min, vertex.position);
+            bounds.max = glm::max(bounds.max, vertex.position);
+        }
+
+        // The farthest vertex rather than the corner, for round meshes that is up to sqrt(3) times tighter
+        bounding_sphere.center = (bounds.min + bounds.max) * 0.5f;
+        float radius_squared = 0.0f;
+        for (auto const &vertex : vertices)
+        {
+            glm::vec3 const offset = vertex.position - bounding_sphere.center;
+            radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+        }
+        bounding_sphere.radius = std::sqrt(radius_squared);
+    }
 
+    model::model(builder const &builder)
+        : model{builder.vertices, builder.indices, builder.lods, builder.meshlets, builder.bounds, builder.bounding_sphere, builder.layout, builder.index_type}
+    {
+    }
 
+    model::model(
+        std::span<vertex const> vertices,
+        std::span<uint32_t const> indices,
+        std::span<lod const> lods,
+        std::span<meshlet const> meshlets,
+        aabb const &bounds,
+        sphere const &bounding_sphere,
+        vertex_layout layout,
+        VkIndexType index_type)
+        : arena_ptr_{&geometry_arena::instance()}
+        , index_type_{index_type}
+        , lods_{lods.begin(), lods.end()}
+        , meshlets_{meshlets.begin(), meshlets.end()}
+        , bounds_{bounds}
+        , bounding_sphere_{bounding_sphere}
+        , layout_{layout}
+    {
+        if (layout_ != vertex_layout::full and not uvs_fit_unorm(vertices))
+        {
 #ifndef NDEBUG
+            std::cout << YELLOW_TEXT("[Model Load]\n") << ONE_TAB << "UVs outside [0, 1], keeping the full vertex layout" << '\n';
+#endif
+            layout_ = vertex_layout::full;
+        }
 
+        // Indices first, narrowing them may throw before any arena range is taken
+        create_index_buffers(indices);
+        create_vertex_buffers(vertices);
+
+        if (lods_.empty())
+        {
+            lods_.push_back({0, index_count_, 0.0f});
+        }
+    }
+
+    model::~model()
+    {
+        arena_ptr_->free(vertex_range_);
+        arena_ptr_->free(index_range_);
+    }
+
+    auto model::create_model(std::string const &file_path, vertex_layout layout) -> std::unique_ptr<model>
+    {
+        using namespace std::chrono;
+        auto const start_time = high_resolution_clock::now();
+
+        builder builder{};
+        builder.layout = layout;
+
+        // Warm start, upload straight from the memory-mapped cache without copying
+        if (auto const cache = mesh_cache::open(ENGINE_DIR + engine::data_path + file_path, builder))
+        {
+#ifndef NDEBUG
+            float const load_ms = duration<float, std::milli>(high_resolution_clock::now() - start_time).count();
+            std::cout << YELLOW_TEXT("[Model Load]\n") << ONE_TAB << GREEN_TEXT("" + file_path + "") << " cache " << load_ms << " ms" << '\n';
 #endif
+            return std::make_unique<model>(
+                cache->vertices(), cache->indices(), cache->lods(), cache->meshlets(), cache->bounds(), cache->bounding_sphere(), layout,
+                smallest_index_type(cache->vertices().size()));
+        }
+
+        // Cold start, load_model reports its own stage timings
+        builder.load_model(file_path);
         return std::make_unique<model>(builder);
     }
 
@@ -238,63 +621,194 @@ namespace dae
     {
         builder builder{};
         builder.vertices = vertices;
+        builder.compute_bounds();
 #ifndef NDEBUG
 #endif
         return std::make_unique<model>(builder);
     }
 
+    auto model::load_builder(std::string const &file_path, vertex_layout layout) -> builder
+    {
+        builder builder{};
+        builder.layout = layout;
+
+        if (auto const cache = mesh_cache::open(ENGINE_DIR + engine::data_path + file_path, builder))
+        {
+            // The mapping closes with the cache, so the streamed copy owns its data
+            builder.vertices.assign(cache->vertices().begin(), cache->vertices().end());
+            builder.indices.assign(cache->indices().begin(), cache->indices().end());
+            builder.lods.assign(cache->lods().begin(), cache->lods().end());
+            builder.meshlets.assign(cache->meshlets().begin(), cache->meshlets().end());
+            builder.bounds = cache->bounds();
+            builder.bounding_sphere = cache->bounding_sphere();
+            builder.select_index_type();
+            return builder;
+        }
+
+        builder.load_model(file_path);
+        return builder;
+    }
+
+    auto model::smallest_index_type(size_t vertex_count) -> VkIndexType
+    {
+        return vertex_count <= size_t{UINT16_MAX} + 1 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    }
+
+    auto model::dequantization_matrix() const -> glm::mat4
+    {
+        if (layout_ == vertex_layout::full)
+        {
+            return glm::mat4{1.0f};
+        }
+
+        glm::vec3 const center      = (bounds_.min + bounds_.max) * 0.5f;
+        glm::vec3 const half_extent = glm::max((bounds_.max - bounds_.min) * 0.5f, glm::vec3{std::numeric_limits<float>::min()});
+        return glm::mat4{
+            glm::vec4{half_extent.x, 0.0f, 0.0f, 0.0f},
+            glm::vec4{0.0f, half_extent.y, 0.0f, 0.0f},
+            glm::vec4{0.0f, 0.0f, half_extent.z, 0.0f},
+            glm::vec4{center, 1.0f}
+        };
+    }
+
+    auto model::resident_bytes() const -> VkDeviceSize
+    {
+        VkDeviceSize bytes = vertex_range_.valid() ? arena_ptr_->size_in_bytes(vertex_range_) : 0;
+        if (index_range_.valid())
+        {
+            bytes += arena_ptr_->size_in_bytes(index_range_);
+        }
+        return bytes;
+    }
+
     void model::bind(VkCommandBuffer command_buffer)
     {
-        VkBuffer     buffers[] = {vertex_buffer_->get_buffer()};
+        VkBuffer     buffers[] = {arena_ptr_->buffer_of(vertex_range_)};
         VkDeviceSize offsets[] = {0};
         vkCmdBindVertexBuffers(command_buffer, 0, 1, buffers, offsets);
 
         if (has_index_buffer_)
         {
-            vkCmdBindIndexBuffer(command_buffer, index_buffer_->get_buffer(), 0, VK_INDEX_TYPE_UINT32);
+            vkCmdBindIndexBuffer(command_buffer, arena_ptr_->buffer_of(index_range_), 0, index_type_);
         }
     }
 
-    void model::draw(VkCommandBuffer command_buffer)
+    auto model::shares_bindings(model const &other) const -> bool
+    {
+        if (arena_ptr_->buffer_of(vertex_range_) != other.arena_ptr_->buffer_of(other.vertex_range_) or has_index_buffer_ != other.has_index_buffer_)
+        {
+            return false;
+        }
+        return not has_index_buffer_ or (index_type_ == other.index_type_ and arena_ptr_->buffer_of(index_range_) == other.arena_ptr_->buffer_of(other.index_range_));
+    }
+
+    void model::draw(VkCommandBuffer command_buffer, uint32_t lod)
     {
         if (has_index_buffer_)
         {
-            vkCmdDrawIndexed(command_buffer, index_count_, 1, 0, 0, 0);
+            auto const &range = lods_[std::min<size_t>(lod, lods_.size() - 1)];
+            vkCmdDrawIndexed(
+                command_buffer, range.index_count, 1,
+                arena_ptr_->first_element(index_range_) + range.first_index,
+                static_cast<int32_t>(arena_ptr_->first_element(vertex_range_)), 0);
         }
         else
         {
-            vkCmdDraw(command_buffer, vertex_count_, 1, 0, 0);
+            vkCmdDraw(command_buffer, vertex_count_, 1, arena_ptr_->first_element(vertex_range_), 0);
         }
     }
 
-    void model::create_vertex_buffers(std::vector<vertex> const &vertices)
+    void model::draw(VkCommandBuffer command_buffer, glm::mat4 const &model_matrix, meshlet_culler &culler)
+    {
+        uint32_t const lod = select_lod(model_matrix, culler.view_camera());
+        if (lod != 0 or meshlets_.empty())
+        {
+            draw(command_buffer, lod);
+            return;
+        }
+
+        uint32_t const first_index   = arena_ptr_->first_element(index_range_);
+        auto const     vertex_offset = static_cast<int32_t>(arena_ptr_->first_element(vertex_range_));
+        for (auto const &range : culler.cull(meshlets_, model_matrix))
+        {
+            vkCmdDrawIndexed(command_buffer, range.index_count, 1, first_index + range.first_index, vertex_offset, 0);
+        }
+    }
+
+    auto model::select_lod(glm::mat4 const &model_matrix, camera const &camera) const -> uint32_t
+    {
+        glm::mat4 const projection = camera.get_projection();
+        if (lods_.size() <= 1 or projection[2][3] == 0.0f)
+        {
+            return 0;
+        }
+
+        glm::vec3 const center = glm::vec3{model_matrix * glm::vec4{(bounds_.min + bounds_.max) * 0.5f, 1.0f}};
+        float const     scale  = std::max({glm::length(glm::vec3{model_matrix[0]}), glm::length(glm::vec3{model_matrix[1]}), glm::length(glm::vec3{model_matrix[2]})});
+        float const     radius = glm::length(bounds_.max - bounds_.min) * 0.5f * scale;
+
+        // Distance to the nearest point of the bounding sphere, the camera inside it always gets full detail
+        float const distance = glm::length(center - camera.get_position()) - radius;
+        if (distance <= 0.0f)
+        {
+            return 0;
+        }
+
+        // An object space error e projects to e * scale * projection[1][1] / distance in normalized device units
+        float const max_error = lod_error_threshold * distance / (scale * projection[1][1]);
+
+        uint32_t selected = 0;
+        while (selected + 1 < lods_.size() and lods_[selected + 1].error <= max_error)
+        {
+            ++selected;
+        }
+        return selected;
+    }
+
+    void model::create_vertex_buffers(std::span<vertex const> vertices)
     {
         vertex_count_ = static_cast<uint32_t>(vertices.size());
         assert(vertex_count_ >= 3 and "Vertex count must be at least 3!");
-        VkDeviceSize buffer_size = sizeof(vertices[0]) * vertex_count_;
+
+        std::vector<std::byte> packed_vertices{};
+        void const *vertex_data = vertices.data();
         uint32_t vertex_size = sizeof(vertices[0]);
+        if (layout_ != vertex_layout::full)
+        {
+            packed_vertices = pack_vertices(vertices);
+            vertex_data = packed_vertices.data();
+            vertex_size = packed_vertex::stride(layout_);
+        }
+        vertex_range_ = arena_ptr_->allocate(geometry_arena::usage::vertex, vertex_size, vertex_count_, vertex_data);
+    }
 
-        buffer staging_buffer {
-            vertex_size,
-            vertex_count_,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        };
+    auto model::pack_vertices(std::span<vertex const> vertices) const -> std::vector<std::byte>
+    {
+        uint32_t const  stride      = packed_vertex::stride(layout_);
+        glm::mat4 const dequantize  = dequantization_matrix();
+        glm::vec3 const center      = dequantize[3];
+        glm::vec3 const inverse_extent{1.0f / dequantize[0][0], 1.0f / dequantize[1][1], 1.0f / dequantize[2][2]};
+
+        std::vector<std::byte> packed(size_t{stride} * vertices.size());
+        for (size_t index = 0; index < vertices.size(); ++index)
+        {
+            vertex const &vertex = vertices[index];
 
-        staging_buffer.map();
-        staging_buffer.write_to_buffer(const_cast<vertex*>(vertices.data()));
+            glm::vec3 const position = glm::clamp((vertex.position - center) * inverse_extent, -1.0f, 1.0f);
 
-        vertex_buffer_ = std::make_unique<buffer>(
-            vertex_size,
-            vertex_count_,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+            packed_vertex packed_vertex{};
+            packed_vertex.position = glm::packHalf4x16(glm::vec4{position, 1.0f});
+            packed_vertex.normal   = glm::packSnorm2x16(octahedral_encode(vertex.normal));
+            packed_vertex.tangent  = glm::packSnorm2x16(octahedral_encode(vertex.tangent));
+            packed_vertex.uv       = glm::packUnorm2x16(vertex.uv);
+            packed_vertex.color    = glm::packUnorm4x8(glm::vec4{glm::clamp(vertex.color, 0.0f, 1.0f), 1.0f});
 
-        device_ptr_->copy_buffer(staging_buffer.get_buffer(), vertex_buffer_->get_buffer(), buffer_size);
+            std::memcpy(packed.data() + index * stride, &packed_vertex, stride);
+        }
+        return packed;
     }
 
-    void model::create_index_buffers(std::vector<uint32_t> const& indices)
+    void model::create_index_buffers(std::span<uint32_t const> indices)
     {
         index_count_ = static_cast<uint32_t>(indices.size());
         has_index_buffer_ = index_count_ > 0;
@@ -303,27 +817,25 @@ namespace dae
         {
             return;
         }
-        
-        VkDeviceSize buffer_size = sizeof(indices[0]) * index_count_;
-        uint32_t index_size = sizeof(indices[0]);
-
-        buffer staging_buffer {
-            index_size,
-            index_count_,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        };
-
-        staging_buffer.map();
-        staging_buffer.write_to_buffer((void*) indices.data());
 
-        index_buffer_ = std::make_unique<buffer>(
-            index_size,
-            index_count_,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+        // Narrowed while staging, the builders and the mesh cache keep 32-bit indices
+        std::vector<uint16_t> narrow_indices{};
+        void const *index_data = indices.data();
+        if (index_type_ == VK_INDEX_TYPE_UINT16)
+        {
+            narrow_indices.reserve(indices.size());
+            for (uint32_t const index : indices)
+            {
+                if (index > UINT16_MAX)
+                {
+                    throw std::runtime_error{"Index " + std::to_string(index) + " does not fit a 16-bit index buffer"};
+                }
+                narrow_indices.push_back(static_cast<uint16_t>(index));
+            }
+            index_data = narrow_indices.data();
+        }
 
-        device_ptr_->copy_buffer(staging_buffer.get_buffer(), index_buffer_->get_buffer(), buffer_size);
+        uint32_t const index_size = index_type_ == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        index_range_ = arena_ptr_->allocate(geometry_arena::usage::index, index_size, index_count_, index_data);
     }
 }
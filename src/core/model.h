@@ -1,10 +1,13 @@
 ﻿#pragma once
 
 // Project includes
-#include "src/vulkan/buffer.h"
+#include "src/vulkan/geometry_arena.h"
 
 // Standard includes
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -20,12 +23,29 @@
 namespace dae
 {
     // Forward declarations
-    class device;
+    class camera;
+    class meshlet_culler;
     
     class model final
     {
     public:
+        // Vertex buffer layout a model is uploaded with, pipelines keep one variant per layout
+        enum class vertex_layout : uint8_t
+        {
+            full,         // vertex, fp32 attributes
+            packed,       // packed_vertex without color
+            packed_color, // packed_vertex with unorm8 color
+        };
+
+        static auto vertex_layout_from_string(std::string const &name) -> vertex_layout;
 
+        // Reordering applied by builder::load_model once the mesh is deduplicated
+        enum class mesh_optimization : uint32_t
+        {
+            none,
+            vertex_cache,              // triangle order for post-transform cache reuse, vertices in fetch order
+            vertex_cache_and_overdraw, // additionally draws outward facing clusters first
+        };
 
         struct vertex
         {
@@ -41,6 +61,53 @@ namespace dae
             bool operator==(vertex const &other) const;
         };
 
+        // Positions are half floats in [-1, 1] over the mesh bounds, model::dequantization_matrix maps them back.
+        // Normal and tangent are octahedral encoded, the tangent's sign carries the handedness.
+        struct packed_vertex
+        {
+            uint64_t position = 0; // half x, y, z, w
+            uint32_t normal   = 0; // octahedral snorm16x2
+            uint32_t tangent  = 0; // octahedral snorm16x2
+            uint32_t uv       = 0; // unorm16x2
+            uint32_t color    = 0; // unorm8x4, only uploaded with vertex_layout::packed_color
+
+            static auto get_binding_description(vertex_layout layout) -> std::vector<VkVertexInputBindingDescription>;
+            static auto get_attribute_descriptions(vertex_layout layout) -> std::vector<VkVertexInputAttributeDescription>;
+            static auto stride(vertex_layout layout) -> uint32_t;
+        };
+
+        struct aabb
+        {
+            glm::vec3 min = {};
+            glm::vec3 max = {};
+        };
+
+        // Centered on the aabb, so culling can test both against the same center
+        struct sphere
+        {
+            glm::vec3 center = {};
+            float     radius = 0.0f;
+        };
+
+        // Draw range of one detail level inside the shared index buffer, level 0 is the full mesh
+        struct lod
+        {
+            uint32_t first_index = 0;
+            uint32_t index_count = 0;
+            float    error       = 0.0f; // object space deviation from level 0
+        };
+
+        // Cluster of level 0 triangles with its culling bounds, the triangles are contiguous in the index buffer
+        struct meshlet
+        {
+            uint32_t  first_index = 0;
+            uint32_t  index_count = 0;
+            glm::vec3 center      = {};
+            float     radius      = 0.0f;
+            glm::vec3 cone_axis   = {};
+            float     cone_cutoff = 1.0f; // sine of the normal cone's spread, 1 disables the backface test
+        };
+
 
 
 
@@ -49,11 +116,47 @@ namespace dae
         {
             std::vector<vertex> vertices = {};
             std::vector<uint32_t> indices = {};
+            std::vector<lod> lods = {};
+            std::vector<meshlet> meshlets = {};
+            aabb bounds = {};
+            sphere bounding_sphere = {};
+
+            // Merges vertices whose attributes fall in the same epsilon-sized grid cell, 0 keeps exact matching
+            float weld_epsilon = 0.0f;
+
+            vertex_layout     layout        = vertex_layout::full;
+            mesh_optimization optimization  = mesh_optimization::vertex_cache;
+            uint32_t          max_lod_count = 4;
+
+            // Width the index buffer is uploaded with, select_index_type narrows it for small meshes
+            VkIndexType index_type = VK_INDEX_TYPE_UINT32;
 
             void load_model(std::string const &file_path);
+            void generate_tangents();
+            void compute_bounds();
+            void generate_lods();
+            void optimize();
+            void build_meshlets();
+            void select_index_type();
+
+            static constexpr size_t min_triangles_per_range = 1 << 14;
+            static constexpr size_t min_vertices_per_range  = 1 << 15;
+            static constexpr size_t min_lod_triangles       = 256;
+            static constexpr float  lod_reduction           = 0.5f;  // triangle ratio between consecutive levels
+            static constexpr float  max_lod_error           = 0.05f; // fraction of the bounding radius
+            static constexpr size_t min_meshlet_triangles   = 4096;  // smaller meshes are drawn whole
         };
         
         explicit model(builder const &builder);
+        model(
+            std::span<vertex const> vertices,
+            std::span<uint32_t const> indices,
+            std::span<lod const> lods,
+            std::span<meshlet const> meshlets,
+            aabb const &bounds,
+            sphere const &bounding_sphere,
+            vertex_layout layout = vertex_layout::full,
+            VkIndexType index_type = VK_INDEX_TYPE_UINT32);
         ~model();
 
         model(model const &)            = delete;
@@ -61,25 +164,64 @@ namespace dae
         model &operator=(model const &) = delete;
         model &operator=(model &&)      = delete;
 
-        static auto create_model(std::string const &file_path) -> std::unique_ptr<model>;
+        static auto create_model(std::string const &file_path, vertex_layout layout = vertex_layout::full) -> std::unique_ptr<model>;
         static auto create_model(std::vector<vertex> const &vertices) -> std::unique_ptr<model>;
 
+        // CPU half of create_model, reads the cache or parses the file without touching the device
+        static auto load_builder(std::string const &file_path, vertex_layout layout = vertex_layout::full) -> builder;
+
+        // 16-bit indices whenever every vertex is addressable by one, 32-bit otherwise
+        static auto smallest_index_type(size_t vertex_count) -> VkIndexType;
+
+        // Binds the arena buffers holding this model, shared by every model with the same layout and index type
         void bind(VkCommandBuffer command_buffer);
-        void draw(VkCommandBuffer command_buffer);
+        [[nodiscard]] auto shares_bindings(model const &other) const -> bool;
+
+        void draw(VkCommandBuffer command_buffer, uint32_t lod = 0);
+
+        // Picks the level for model_matrix, at level 0 only the meshlets that survive culling are drawn
+        void draw(VkCommandBuffer command_buffer, glm::mat4 const &model_matrix, meshlet_culler &culler);
+
+        // Coarsest level whose error projects below lod_error_threshold, level 0 for orthographic cameras
+        [[nodiscard]] auto select_lod(glm::mat4 const &model_matrix, camera const &camera) const -> uint32_t;
+
+        // Projected error in normalized device units, about one pixel at a 1000 pixel high viewport
+        static constexpr float lod_error_threshold = 0.002f;
+
+        [[nodiscard]] auto bounds() const -> aabb const & { return bounds_; }
+        [[nodiscard]] auto bounding_sphere() const -> sphere const & { return bounding_sphere_; }
+        [[nodiscard]] auto layout() const -> vertex_layout { return layout_; }
+        [[nodiscard]] auto index_type() const -> VkIndexType { return index_type_; }
+        [[nodiscard]] auto lods() const -> std::vector<lod> const & { return lods_; }
+        [[nodiscard]] auto meshlets() const -> std::vector<meshlet> const & { return meshlets_; }
+
+        // Device-local bytes held by the vertex and index buffers
+        [[nodiscard]] auto resident_bytes() const -> VkDeviceSize;
+
+        // Maps packed positions back to object space, identity for vertex_layout::full
+        [[nodiscard]] auto dequantization_matrix() const -> glm::mat4;
 
     private:
-        void create_vertex_buffers(std::vector<vertex> const &vertices);
-        void create_index_buffers(std::vector<uint32_t> const &indices);
+        void create_vertex_buffers(std::span<vertex const> vertices);
+        auto pack_vertices(std::span<vertex const> vertices) const -> std::vector<std::byte>;
+        void create_index_buffers(std::span<uint32_t const> indices);
         
 
     private:
-        device *device_ptr_ = nullptr;
-        
-        std::unique_ptr<buffer> vertex_buffer_ = nullptr;
-        uint32_t                vertex_count_  = 0;
+        geometry_arena *arena_ptr_ = nullptr;
+
+        geometry_arena::handle vertex_range_ = {};
+        uint32_t               vertex_count_ = 0;
+
+        bool                   has_index_buffer_ = false;
+        geometry_arena::handle index_range_      = {};
+        uint32_t               index_count_      = 0;
+        VkIndexType            index_type_       = VK_INDEX_TYPE_UINT32;
+        std::vector<lod>       lods_             = {};
+        std::vector<meshlet>   meshlets_         = {};
 
-        bool                    has_index_buffer_ = false;
-        std::unique_ptr<buffer> index_buffer_     = nullptr;
-        uint32_t                index_count_      = 0;
+        aabb          bounds_          = {};
+        sphere        bounding_sphere_ = {};
+        vertex_layout layout_          = vertex_layout::full;
     };
 }
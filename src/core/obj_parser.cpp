@@ -0,0 +1,424 @@
+﻿#include "obj_parser.h"
+
+// Project includes
+#include "src/utility/mapped_file.h"
+
+// Standard includes
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace dae
+{
+    namespace
+    {
+        constexpr size_t min_chunk_size = 1 << 20;
+
+        auto is_space(char c) -> bool { return c == ' ' or c == '\t'; }
+        auto is_separator(char c) -> bool { return c == ' ' or c == '\t' or c == '\r'; }
+
+        void skip_space(char const *&cursor, char const *end)
+        {
+            while (cursor < end and is_space(*cursor))
+            {
+                ++cursor;
+            }
+        }
+
+        // Same token rules as tinyobj's parseReal: on failure the token is consumed and false returned
+        auto parse_real(char const *&cursor, char const *end, float &value) -> bool
+        {
+            skip_space(cursor, end);
+            char const *token_end = cursor;
+            while (token_end < end and not is_separator(*token_end))
+            {
+                ++token_end;
+            }
+
+            char const *first = cursor;
+            if (first < token_end and *first == '+')
+            {
+                ++first;
+            }
+            cursor = token_end;
+
+            double parsed = 0.0;
+            auto const [last, error] = std::from_chars(first, token_end, parsed, std::chars_format::general);
+            if (error != std::errc{} or last == first)
+            {
+                return false;
+            }
+
+            value = static_cast<float>(parsed);
+            return true;
+        }
+
+        auto parse_real_or(char const *&cursor, char const *end, float default_value) -> float
+        {
+            float value = default_value;
+            parse_real(cursor, end, value);
+            return value;
+        }
+
+        // atoi semantics, a missing number reads as 0. The cursor stops at the next '/' or separator.
+        auto parse_int(char const *&cursor, char const *end) -> int32_t
+        {
+            char const *first = cursor;
+            if (first < end and *first == '+')
+            {
+                ++first;
+            }
+
+            int32_t value = 0;
+            std::from_chars(first, end, value);
+
+            while (cursor < end and *cursor != '/' and not is_separator(*cursor))
+            {
+                ++cursor;
+            }
+            return value;
+        }
+    }
+
+    struct obj_parser::chunk
+    {
+        char const *begin = nullptr;
+        char const *end   = nullptr;
+
+        std::vector<float>    vertices        = {};
+        std::vector<float>    colors          = {};
+        std::vector<float>    normals         = {};
+        std::vector<float>    texcoords       = {};
+        std::vector<index>    corners         = {};
+        std::vector<uint8_t>  face_sizes      = {}; // corner count per face, at most 4
+        std::vector<uint32_t> local_fixups    = {}; // corner * 3 + component of relative indices that still need the chunk base
+
+        size_t vertex_base    = 0;
+        size_t normal_base    = 0;
+        size_t texcoord_base  = 0;
+        size_t triangle_base  = 0;
+        size_t triangle_count = 0;
+
+        bool               needs_ear_clipping = false;
+        std::exception_ptr error              = nullptr;
+    };
+
+    auto obj_parser::parse(std::string const &file_path, result &out, uint32_t thread_count) -> bool
+    {
+        mapped_file file{file_path};
+        if (not file.is_open())
+        {
+            throw std::runtime_error{"failed to open " + file_path};
+        }
+
+        if (thread_count == 0)
+        {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Split into line-aligned chunks
+        auto const *const file_begin = reinterpret_cast<char const *>(file.data());
+        auto const *const file_end   = file_begin + file.size();
+
+        size_t const chunk_count = std::clamp<size_t>(file.size() / min_chunk_size, 1, thread_count);
+        std::vector<chunk> chunks(chunk_count);
+
+        char const *chunk_begin = file_begin;
+        for (size_t i = 0; i < chunk_count; ++i)
+        {
+            char const *chunk_end = i + 1 == chunk_count ? file_end : std::max(chunk_begin, file_begin + file.size() * (i + 1) / chunk_count);
+            chunk_end = std::find(chunk_end, file_end, '\n');
+            chunk_end = chunk_end == file_end ? file_end : chunk_end + 1;
+
+            chunks[i].begin = chunk_begin;
+            chunks[i].end   = chunk_end;
+            chunk_begin     = chunk_end;
+        }
+
+        auto const run_parallel = [&chunks](auto const &task)
+        {
+            std::vector<std::thread> workers{};
+            workers.reserve(chunks.size() - 1);
+            for (size_t i = 1; i < chunks.size(); ++i)
+            {
+                workers.emplace_back([&task, &chunk = chunks[i]]
+                {
+                    try { task(chunk); }
+                    catch (...) { chunk.error = std::current_exception(); }
+                });
+            }
+
+            try { task(chunks[0]); }
+            catch (...) { chunks[0].error = std::current_exception(); }
+
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+
+            for (auto const &chunk : chunks)
+            {
+                if (chunk.error)
+                {
+                    std::rethrow_exception(chunk.error);
+                }
+            }
+        };
+
+        run_parallel([](chunk &chunk) { parse_chunk(chunk); });
+
+        if (std::ranges::any_of(chunks, [](chunk const &chunk) { return chunk.needs_ear_clipping; }))
+        {
+            return false;
+        }
+
+        // Prefix sums give every chunk its place in the merged streams
+        size_t vertex_count   = 0;
+        size_t normal_count   = 0;
+        size_t texcoord_count = 0;
+        size_t triangle_count = 0;
+        for (auto &chunk : chunks)
+        {
+            chunk.vertex_base   = vertex_count;
+            chunk.normal_base   = normal_count;
+            chunk.texcoord_base = texcoord_count;
+            chunk.triangle_base = triangle_count;
+
+            vertex_count   += chunk.vertices.size() / 3;
+            normal_count   += chunk.normals.size() / 3;
+            texcoord_count += chunk.texcoords.size() / 2;
+            triangle_count += chunk.triangle_count;
+        }
+
+        out.vertices.resize(vertex_count * 3);
+        out.colors.resize(vertex_count * 3);
+        out.normals.resize(normal_count * 3);
+        out.texcoords.resize(texcoord_count * 2);
+        out.indices.resize(triangle_count * 3);
+
+        run_parallel([&out](chunk &chunk) { merge_chunk(chunk, out); });
+        run_parallel([&out](chunk const &chunk) { triangulate_chunk(chunk, out); });
+        return true;
+    }
+
+    void obj_parser::parse_chunk(chunk &chunk)
+    {
+        char const *line_begin = chunk.begin;
+        while (line_begin < chunk.end)
+        {
+            char const *line_end = std::find(line_begin, chunk.end, '\n');
+            char const *next     = line_end == chunk.end ? line_end : line_end + 1;
+            if (line_end > line_begin and line_end[-1] == '\r')
+            {
+                --line_end;
+            }
+
+            char const *cursor = line_begin;
+            line_begin = next;
+
+            skip_space(cursor, line_end);
+            if (line_end - cursor < 2 or *cursor == '#')
+            {
+                continue;
+            }
+
+            if (cursor[0] == 'v' and is_space(cursor[1]))
+            {
+                cursor += 2;
+                float const x = parse_real_or(cursor, line_end, 0.0f);
+                float const y = parse_real_or(cursor, line_end, 0.0f);
+                float const z = parse_real_or(cursor, line_end, 0.0f);
+
+                // Matches tinyobj's default vertex color fallback: xyz -> white, xyzw -> (w, 1, 1), xyzrg -> white
+                float r = 1.0f;
+                float g = 1.0f;
+                float b = 1.0f;
+                if (parse_real(cursor, line_end, r) and parse_real(cursor, line_end, g) and not parse_real(cursor, line_end, b))
+                {
+                    r = 1.0f;
+                    g = 1.0f;
+                }
+
+                chunk.vertices.insert(chunk.vertices.end(), {x, y, z});
+                chunk.colors.insert(chunk.colors.end(), {r, g, b});
+                continue;
+            }
+
+            if (line_end - cursor < 3)
+            {
+                continue;
+            }
+
+            if (cursor[0] == 'v' and cursor[1] == 'n' and is_space(cursor[2]))
+            {
+                cursor += 3;
+                float const x = parse_real_or(cursor, line_end, 0.0f);
+                float const y = parse_real_or(cursor, line_end, 0.0f);
+                float const z = parse_real_or(cursor, line_end, 0.0f);
+                chunk.normals.insert(chunk.normals.end(), {x, y, z});
+                continue;
+            }
+
+            if (cursor[0] == 'v' and cursor[1] == 't' and is_space(cursor[2]))
+            {
+                cursor += 3;
+                float const u = parse_real_or(cursor, line_end, 0.0f);
+                float const v = parse_real_or(cursor, line_end, 0.0f);
+                chunk.texcoords.insert(chunk.texcoords.end(), {u, v});
+                continue;
+            }
+
+            if (cursor[0] == 'f' and is_space(cursor[1]))
+            {
+                cursor += 2;
+                skip_space(cursor, line_end);
+
+                auto const vertex_count   = static_cast<int32_t>(chunk.vertices.size() / 3);
+                auto const normal_count   = static_cast<int32_t>(chunk.normals.size() / 3);
+                auto const texcoord_count = static_cast<int32_t>(chunk.texcoords.size() / 2);
+
+                // Positive indices are absolute, negative ones are relative to what this chunk has seen so far
+                auto const fix_index = [&chunk](int32_t value, int32_t local_count, uint32_t component, bool allow_zero) -> int32_t
+                {
+                    if (value > 0)
+                    {
+                        return value - 1;
+                    }
+                    if (value == 0)
+                    {
+                        if (not allow_zero)
+                        {
+                            throw std::runtime_error{"obj face with a zero vertex index"};
+                        }
+                        return -1;
+                    }
+                    chunk.local_fixups.push_back(static_cast<uint32_t>(chunk.corners.size() * 3 + component));
+                    return local_count + value;
+                };
+
+                size_t face_size = 0;
+                while (cursor < line_end)
+                {
+                    index corner{};
+                    corner.vertex_index = fix_index(parse_int(cursor, line_end), vertex_count, 0, false);
+
+                    if (cursor < line_end and *cursor == '/')
+                    {
+                        ++cursor;
+                        if (cursor < line_end and *cursor == '/')
+                        {
+                            ++cursor;
+                            corner.normal_index = fix_index(parse_int(cursor, line_end), normal_count, 1, true);
+                        }
+                        else
+                        {
+                            corner.texcoord_index = fix_index(parse_int(cursor, line_end), texcoord_count, 2, true);
+                            if (cursor < line_end and *cursor == '/')
+                            {
+                                ++cursor;
+                                corner.normal_index = fix_index(parse_int(cursor, line_end), normal_count, 1, true);
+                            }
+                        }
+                    }
+
+                    chunk.corners.push_back(corner);
+                    ++face_size;
+
+                    while (cursor < line_end and is_separator(*cursor))
+                    {
+                        ++cursor;
+                    }
+                }
+
+                if (face_size > 4)
+                {
+                    chunk.needs_ear_clipping = true;
+                    return;
+                }
+
+                chunk.face_sizes.push_back(static_cast<uint8_t>(face_size));
+                chunk.triangle_count += face_size >= 3 ? face_size - 2 : 0;
+            }
+        }
+    }
+
+    void obj_parser::merge_chunk(chunk &chunk, result &out)
+    {
+        std::ranges::copy(chunk.vertices, out.vertices.begin() + static_cast<ptrdiff_t>(chunk.vertex_base * 3));
+        std::ranges::copy(chunk.colors, out.colors.begin() + static_cast<ptrdiff_t>(chunk.vertex_base * 3));
+        std::ranges::copy(chunk.normals, out.normals.begin() + static_cast<ptrdiff_t>(chunk.normal_base * 3));
+        std::ranges::copy(chunk.texcoords, out.texcoords.begin() + static_cast<ptrdiff_t>(chunk.texcoord_base * 2));
+
+        std::vector<float>{}.swap(chunk.vertices);
+        std::vector<float>{}.swap(chunk.colors);
+        std::vector<float>{}.swap(chunk.normals);
+        std::vector<float>{}.swap(chunk.texcoords);
+
+        for (uint32_t const fixup : chunk.local_fixups)
+        {
+            index &corner = chunk.corners[fixup / 3];
+            switch (fixup % 3)
+            {
+                case 0: corner.vertex_index   += static_cast<int32_t>(chunk.vertex_base); break;
+                case 1: corner.normal_index   += static_cast<int32_t>(chunk.normal_base); break;
+                case 2: corner.texcoord_index += static_cast<int32_t>(chunk.texcoord_base); break;
+                default: break;
+            }
+        }
+
+        auto const vertex_count   = static_cast<int32_t>(out.vertices.size() / 3);
+        auto const normal_count   = static_cast<int32_t>(out.normals.size() / 3);
+        auto const texcoord_count = static_cast<int32_t>(out.texcoords.size() / 2);
+        for (auto const &corner : chunk.corners)
+        {
+            if (corner.vertex_index < 0 or corner.vertex_index >= vertex_count or
+                corner.normal_index < -1 or corner.normal_index >= normal_count or
+                corner.texcoord_index < -1 or corner.texcoord_index >= texcoord_count)
+            {
+                throw std::runtime_error{"obj face index out of range"};
+            }
+        }
+    }
+
+    void obj_parser::triangulate_chunk(chunk const &chunk, result &out)
+    {
+        auto       output = out.indices.begin() + static_cast<ptrdiff_t>(chunk.triangle_base * 3);
+        auto const corner_position = [&out](index const &corner, int axis) { return out.vertices[static_cast<size_t>(corner.vertex_index) * 3 + axis]; };
+
+        size_t corner = 0;
+        for (uint8_t const face_size : chunk.face_sizes)
+        {
+            index const *face = chunk.corners.data() + corner;
+            corner += face_size;
+
+            if (face_size == 3)
+            {
+                output = std::copy(face, face + 3, output);
+            }
+            else if (face_size == 4)
+            {
+                // Split along the shorter diagonal, same rule and float math as tinyobj
+                float const e02x = corner_position(face[2], 0) - corner_position(face[0], 0);
+                float const e02y = corner_position(face[2], 1) - corner_position(face[0], 1);
+                float const e02z = corner_position(face[2], 2) - corner_position(face[0], 2);
+                float const e13x = corner_position(face[3], 0) - corner_position(face[1], 0);
+                float const e13y = corner_position(face[3], 1) - corner_position(face[1], 1);
+                float const e13z = corner_position(face[3], 2) - corner_position(face[1], 2);
+
+                float const sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+                float const sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+                if (sqr02 < sqr13)
+                {
+                    for (int const i : {0, 1, 2, 0, 2, 3}) { *output++ = face[i]; }
+                }
+                else
+                {
+                    for (int const i : {0, 1, 3, 1, 2, 3}) { *output++ = face[i]; }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+
+// Standard includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+    // Parallel OBJ reader, the file is split into line-aligned chunks that are parsed on worker threads
+    // and merged afterward. Field names mirror tinyobj::attrib_t / index_t so both feed the same builder code.
+    class obj_parser final
+    {
+    public:
+        struct index
+        {
+            int32_t vertex_index   = -1;
+            int32_t normal_index   = -1;
+            int32_t texcoord_index = -1;
+        };
+
+        struct result
+        {
+            std::vector<float> vertices  = {};
+            std::vector<float> colors    = {};
+            std::vector<float> normals   = {};
+            std::vector<float> texcoords = {};
+            std::vector<index> indices   = {}; // triangulated corners in file order
+        };
+
+        // Returns false when the file holds polygons with more than 4 corners, those need tinyobj's ear clipping.
+        // Throws on I/O errors and invalid indices.
+        static auto parse(std::string const &file_path, result &out, uint32_t thread_count = 0) -> bool;
+
+    private:
+        struct chunk;
+
+        static void parse_chunk(chunk &chunk);
+        static void merge_chunk(chunk &chunk, result &out);
+        static void triangulate_chunk(chunk const &chunk, result &out);
+    };
+}
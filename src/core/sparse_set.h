@@ -0,0 +1,107 @@
+﻿#pragma once
+
+// Standard includes
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace dae
+{
+    // Components of one type packed into a dense array, found per entity through a sparse array indexed by the
+    // entity. Iterating components() touches only live components in order, removal moves the last one into the gap.
+    // References into the dense array are invalidated by emplace and remove.
+    template <typename T>
+    class sparse_set final
+    {
+    public:
+        using entity = uint32_t;
+
+        template <typename... Args>
+        auto emplace(entity id, Args &&...args) -> T &
+        {
+            assert(not contains(id) and "Entity already has this component");
+            if (id >= sparse_.size())
+            {
+                sparse_.resize(id + 1, no_index);
+            }
+            sparse_[id] = static_cast<uint32_t>(entities_.size());
+            entities_.push_back(id);
+            components_.push_back(T{std::forward<Args>(args)...});
+            return components_.back();
+        }
+
+        void remove(entity id)
+        {
+            assert(contains(id) and "Entity does not have this component");
+            uint32_t const index = sparse_[id];
+            entity const   last  = entities_.back();
+
+            entities_[index]   = last;
+            components_[index] = std::move(components_.back());
+            sparse_[last]      = index;
+            sparse_[id]        = no_index;
+            entities_.pop_back();
+            components_.pop_back();
+        }
+
+        [[nodiscard]] auto contains(entity id) const -> bool { return id < sparse_.size() and sparse_[id] != no_index; }
+
+        [[nodiscard]] auto get(entity id) -> T &
+        {
+            assert(contains(id) and "Entity does not have this component");
+            return components_[sparse_[id]];
+        }
+
+        [[nodiscard]] auto get(entity id) const -> T const &
+        {
+            assert(contains(id) and "Entity does not have this component");
+            return components_[sparse_[id]];
+        }
+
+        // Position of the entity's component in the dense arrays
+        [[nodiscard]] auto index_of(entity id) const -> uint32_t
+        {
+            assert(contains(id) and "Entity does not have this component");
+            return sparse_[id];
+        }
+
+        [[nodiscard]] auto find(entity id) -> T * { return contains(id) ? &components_[sparse_[id]] : nullptr; }
+        [[nodiscard]] auto find(entity id) const -> T const * { return contains(id) ? &components_[sparse_[id]] : nullptr; }
+
+        [[nodiscard]] auto size() const -> size_t { return components_.size(); }
+        [[nodiscard]] auto empty() const -> bool { return components_.empty(); }
+
+        // Parallel arrays, entities()[i] owns components()[i]
+        [[nodiscard]] auto entities() const -> std::span<entity const> { return entities_; }
+        [[nodiscard]] auto components() -> std::span<T> { return components_; }
+        [[nodiscard]] auto components() const -> std::span<T const> { return components_; }
+
+        // Rearranges the dense arrays so that position i holds what was at order[i], order has one entry per component
+        void permute(std::span<uint32_t const> order)
+        {
+            assert(order.size() == components_.size() and "Order has to cover every component");
+            std::vector<entity> entities{};
+            std::vector<T>      components{};
+            entities.reserve(order.size());
+            components.reserve(order.size());
+            for (uint32_t const index : order)
+            {
+                sparse_[entities_[index]] = static_cast<uint32_t>(entities.size());
+                entities.push_back(entities_[index]);
+                components.push_back(std::move(components_[index]));
+            }
+            entities_   = std::move(entities);
+            components_ = std::move(components);
+        }
+
+    private:
+        static constexpr uint32_t no_index = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint32_t> sparse_     = {};
+        std::vector<entity>   entities_   = {};
+        std::vector<T>        components_ = {};
+    };
+}
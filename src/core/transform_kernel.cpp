@@ -0,0 +1,195 @@
+﻿#include "transform_kernel.h"
+
+// Project includes
+#include "src/core/transform_kernel_simd.h"
+
+#if defined(DAE_TRANSFORM_KERNEL_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace dae
+{
+#if defined(DAE_TRANSFORM_KERNEL_X86)
+    namespace transform_kernel_detail
+    {
+        struct sse2_ops
+        {
+            using vf = __m128;
+            using vi = __m128i;
+
+            static constexpr size_t width = 4;
+
+            static auto load(float const *data) -> vf { return _mm_loadu_ps(data); }
+            static auto set1(float value) -> vf { return _mm_set1_ps(value); }
+            static auto add(vf a, vf b) -> vf { return _mm_add_ps(a, b); }
+            static auto sub(vf a, vf b) -> vf { return _mm_sub_ps(a, b); }
+            static auto mul(vf a, vf b) -> vf { return _mm_mul_ps(a, b); }
+            static auto div(vf a, vf b) -> vf { return _mm_div_ps(a, b); }
+            static auto bit_and(vf a, vf b) -> vf { return _mm_and_ps(a, b); }
+            static auto bit_andnot(vf a, vf b) -> vf { return _mm_andnot_ps(a, b); }
+            static auto bit_or(vf a, vf b) -> vf { return _mm_or_ps(a, b); }
+            static auto bit_xor(vf a, vf b) -> vf { return _mm_xor_ps(a, b); }
+
+            static auto to_int(vf a) -> vi { return _mm_cvttps_epi32(a); }
+            static auto to_float(vi a) -> vf { return _mm_cvtepi32_ps(a); }
+            static auto as_float(vi a) -> vf { return _mm_castsi128_ps(a); }
+            static auto iset1(int value) -> vi { return _mm_set1_epi32(value); }
+            static auto iadd(vi a, vi b) -> vi { return _mm_add_epi32(a, b); }
+            static auto isub(vi a, vi b) -> vi { return _mm_sub_epi32(a, b); }
+            static auto iand(vi a, vi b) -> vi { return _mm_and_si128(a, b); }
+            static auto iandnot(vi a, vi b) -> vi { return _mm_andnot_si128(a, b); }
+            static auto icmpeq(vi a, vi b) -> vi { return _mm_cmpeq_epi32(a, b); }
+            static auto islli29(vi a) -> vi { return _mm_slli_epi32(a, 29); }
+
+            // elements[column * 4 + row] holds that element of four matrices
+            static void store_matrices(vf const (&elements)[16], float *matrices)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    vf x = elements[column * 4 + 0];
+                    vf y = elements[column * 4 + 1];
+                    vf z = elements[column * 4 + 2];
+                    vf w = elements[column * 4 + 3];
+                    _MM_TRANSPOSE4_PS(x, y, z, w);
+                    _mm_storeu_ps(matrices + column * 4, x);
+                    _mm_storeu_ps(matrices + 16 + column * 4, y);
+                    _mm_storeu_ps(matrices + 32 + column * 4, z);
+                    _mm_storeu_ps(matrices + 48 + column * 4, w);
+                }
+            }
+        };
+
+        auto compose_sse2(transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices) -> size_t
+        {
+            return compose<sse2_ops>(input, count, world_matrices, normal_matrices);
+        }
+
+        static auto cpu_supports_avx2() -> bool
+        {
+#if defined(_MSC_VER)
+            int info[4]{};
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+
+            // AVX state has to be enabled by the OS as well
+            __cpuid(info, 1);
+            bool const os_saves_avx = (info[2] & (1 << 27)) and (info[2] & (1 << 28)) and (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            return os_saves_avx and (info[1] & (1 << 5));
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+    }
+#endif
+
+    void transform_kernel::compose(transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices)
+    {
+        compose(best_instruction_set(), input, count, world_matrices, normal_matrices);
+    }
+
+    void transform_kernel::compose(instruction_set set, transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices)
+    {
+        size_t done = 0;
+#if defined(DAE_TRANSFORM_KERNEL_X86)
+        if (set == instruction_set::avx2 and best_instruction_set() == instruction_set::avx2)
+        {
+            done = transform_kernel_detail::compose_avx2(input, count, world_matrices, normal_matrices);
+        }
+        if (set != instruction_set::scalar)
+        {
+            done += transform_kernel_detail::compose_sse2(
+                {input.translation_x + done, input.translation_y + done, input.translation_z + done,
+                 input.rotation_x + done, input.rotation_y + done, input.rotation_z + done,
+                 input.scale_x + done, input.scale_y + done, input.scale_z + done},
+                count - done,
+                world_matrices + done,
+                normal_matrices + done);
+        }
+#endif
+
+        for (size_t i = done; i < count; ++i)
+        {
+            compose_one(
+                {input.translation_x[i], input.translation_y[i], input.translation_z[i]},
+                {input.rotation_x[i], input.rotation_y[i], input.rotation_z[i]},
+                {input.scale_x[i], input.scale_y[i], input.scale_z[i]},
+                world_matrices[i],
+                normal_matrices[i]);
+        }
+    }
+
+    void transform_kernel::compose_one(glm::vec3 const &translation, glm::vec3 const &rotation, glm::vec3 const &scale, glm::mat4 &world_matrix, glm::mat4 &normal_matrix)
+    {
+        // The normal matrix is the world matrix's rotation with the inverse scale, both share one set of sin and cos
+        const float c3 = glm::cos(rotation.z);
+        const float s3 = glm::sin(rotation.z);
+        const float c2 = glm::cos(rotation.x);
+        const float s2 = glm::sin(rotation.x);
+        const float c1 = glm::cos(rotation.y);
+        const float s1 = glm::sin(rotation.y);
+        world_matrix = glm::mat4{
+                {
+                    scale.x * (c1 * c3 + s1 * s2 * s3),
+                    scale.x * (c2 * s3),
+                    scale.x * (c1 * s2 * s3 - c3 * s1),
+                    0.0f,
+                },
+                {
+                    scale.y * (c3 * s1 * s2 - c1 * s3),
+                    scale.y * (c2 * c3),
+                    scale.y * (c1 * c3 * s2 + s1 * s3),
+                    0.0f,
+                },
+                {
+                    scale.z * (c2 * s1),
+                    scale.z * (-s2),
+                    scale.z * (c1 * c2),
+                    0.0f,
+                },
+                {translation.x, translation.y, translation.z, 1.0f}
+        };
+
+        glm::vec3 const inverse_scale = 1.0f / scale;
+        normal_matrix = glm::mat3{
+                {
+                    inverse_scale.x * (c1 * c3 + s1 * s2 * s3),
+                    inverse_scale.x * (c2 * s3),
+                    inverse_scale.x * (c1 * s2 * s3 - c3 * s1)
+                },
+                {
+                    inverse_scale.y * (c3 * s1 * s2 - c1 * s3),
+                    inverse_scale.y * (c2 * c3),
+                    inverse_scale.y * (c1 * c3 * s2 + s1 * s3)
+                },
+                {
+                    inverse_scale.z * (c2 * s1),
+                    inverse_scale.z * (-s2),
+                    inverse_scale.z * (c1 * c2)
+                }
+        };
+    }
+
+    auto transform_kernel::best_instruction_set() -> instruction_set
+    {
+#if defined(DAE_TRANSFORM_KERNEL_X86)
+        static instruction_set const best = transform_kernel_detail::cpu_supports_avx2() ? instruction_set::avx2 : instruction_set::sse2;
+        return best;
+#else
+        return instruction_set::scalar;
+#endif
+    }
+
+    auto transform_kernel::instruction_set_name(instruction_set set) -> char const *
+    {
+        switch (set)
+        {
+        case instruction_set::avx2: return "AVX2";
+        case instruction_set::sse2: return "SSE2";
+        default:                    return "scalar";
+        }
+    }
+}
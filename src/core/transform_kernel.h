@@ -0,0 +1,52 @@
+﻿#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+
+// GLM includes
+#include <glm/glm.hpp>
+
+namespace dae
+{
+    // Structure of arrays input of transform_kernel, every pointer addresses count floats
+    struct transform_soa
+    {
+        float const *translation_x = nullptr;
+        float const *translation_y = nullptr;
+        float const *translation_z = nullptr;
+        float const *rotation_x    = nullptr;
+        float const *rotation_y    = nullptr;
+        float const *rotation_z    = nullptr;
+        float const *scale_x       = nullptr;
+        float const *scale_y       = nullptr;
+        float const *scale_z       = nullptr;
+    };
+
+    // Composes world and normal matrices from translation, Tait-Bryan rotation (Y, X, Z) and scale, four or eight
+    // transforms at a time with SSE2 or AVX2. The instruction set is picked once from what the CPU supports, the
+    // scalar path is the reference and handles what is left over. sin and cos are evaluated with a polynomial in
+    // the SIMD paths, their results stay within a few ulp of the scalar ones.
+    class transform_kernel final
+    {
+    public:
+        enum class instruction_set : uint8_t
+        {
+            scalar,
+            sse2,
+            avx2,
+        };
+
+        // Writes count world and normal matrices
+        static void compose(transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices);
+
+        // Same as compose but with the given instruction set, falls back to a narrower one the CPU supports
+        static void compose(instruction_set set, transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices);
+
+        // Scalar reference for one transform, what the SIMD paths are held to
+        static void compose_one(glm::vec3 const &translation, glm::vec3 const &rotation, glm::vec3 const &scale, glm::mat4 &world_matrix, glm::mat4 &normal_matrix);
+
+        [[nodiscard]] static auto best_instruction_set() -> instruction_set;
+        [[nodiscard]] static auto instruction_set_name(instruction_set set) -> char const *;
+    };
+}
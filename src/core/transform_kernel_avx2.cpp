@@ -0,0 +1,78 @@
+﻿// Only this translation unit is compiled for AVX2, transform_kernel calls into it after checking the CPU
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+// Project includes
+#include "src/core/transform_kernel_simd.h"
+
+namespace dae::transform_kernel_detail
+{
+#if defined(DAE_TRANSFORM_KERNEL_X86)
+    struct avx2_ops
+    {
+        using vf = __m256;
+        using vi = __m256i;
+
+        static constexpr size_t width = 8;
+
+        static auto load(float const *data) -> vf { return _mm256_loadu_ps(data); }
+        static auto set1(float value) -> vf { return _mm256_set1_ps(value); }
+        static auto add(vf a, vf b) -> vf { return _mm256_add_ps(a, b); }
+        static auto sub(vf a, vf b) -> vf { return _mm256_sub_ps(a, b); }
+        static auto mul(vf a, vf b) -> vf { return _mm256_mul_ps(a, b); }
+        static auto div(vf a, vf b) -> vf { return _mm256_div_ps(a, b); }
+        static auto bit_and(vf a, vf b) -> vf { return _mm256_and_ps(a, b); }
+        static auto bit_andnot(vf a, vf b) -> vf { return _mm256_andnot_ps(a, b); }
+        static auto bit_or(vf a, vf b) -> vf { return _mm256_or_ps(a, b); }
+        static auto bit_xor(vf a, vf b) -> vf { return _mm256_xor_ps(a, b); }
+
+        static auto to_int(vf a) -> vi { return _mm256_cvttps_epi32(a); }
+        static auto to_float(vi a) -> vf { return _mm256_cvtepi32_ps(a); }
+        static auto as_float(vi a) -> vf { return _mm256_castsi256_ps(a); }
+        static auto iset1(int value) -> vi { return _mm256_set1_epi32(value); }
+        static auto iadd(vi a, vi b) -> vi { return _mm256_add_epi32(a, b); }
+        static auto isub(vi a, vi b) -> vi { return _mm256_sub_epi32(a, b); }
+        static auto iand(vi a, vi b) -> vi { return _mm256_and_si256(a, b); }
+        static auto iandnot(vi a, vi b) -> vi { return _mm256_andnot_si256(a, b); }
+        static auto icmpeq(vi a, vi b) -> vi { return _mm256_cmpeq_epi32(a, b); }
+        static auto islli29(vi a) -> vi { return _mm256_slli_epi32(a, 29); }
+
+        // elements[column * 4 + row] holds that element of eight matrices. The transpose works within each 128 bit
+        // half, so the low half ends up with one of the first four matrices and the high half with one of the rest.
+        static void store_matrices(vf const (&elements)[16], float *matrices)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                vf const xy_low  = _mm256_unpacklo_ps(elements[column * 4 + 0], elements[column * 4 + 1]);
+                vf const xy_high = _mm256_unpackhi_ps(elements[column * 4 + 0], elements[column * 4 + 1]);
+                vf const zw_low  = _mm256_unpacklo_ps(elements[column * 4 + 2], elements[column * 4 + 3]);
+                vf const zw_high = _mm256_unpackhi_ps(elements[column * 4 + 2], elements[column * 4 + 3]);
+
+                vf const columns[4] = {
+                    _mm256_shuffle_ps(xy_low, zw_low, _MM_SHUFFLE(1, 0, 1, 0)),
+                    _mm256_shuffle_ps(xy_low, zw_low, _MM_SHUFFLE(3, 2, 3, 2)),
+                    _mm256_shuffle_ps(xy_high, zw_high, _MM_SHUFFLE(1, 0, 1, 0)),
+                    _mm256_shuffle_ps(xy_high, zw_high, _MM_SHUFFLE(3, 2, 3, 2)),
+                };
+                for (int i = 0; i < 4; ++i)
+                {
+                    _mm_storeu_ps(matrices + i * 16 + column * 4, _mm256_castps256_ps128(columns[i]));
+                    _mm_storeu_ps(matrices + (i + 4) * 16 + column * 4, _mm256_extractf128_ps(columns[i], 1));
+                }
+            }
+        }
+    };
+
+    auto compose_avx2(transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices) -> size_t
+    {
+        return compose<avx2_ops>(input, count, world_matrices, normal_matrices);
+    }
+#endif
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
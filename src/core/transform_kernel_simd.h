@@ -0,0 +1,127 @@
+﻿#pragma once
+
+// Shared by the SSE2 and AVX2 translation units of transform_kernel. The AVX2 one enables the instruction set
+// before including this, so its instantiations are compiled for it while the rest of the program is not. Nothing
+// here calls inline functions of other headers, a copy of those compiled for AVX2 could be the one that gets linked.
+// Matrices are written as 16 consecutive floats for the same reason.
+
+// Project includes
+#include "src/core/transform_kernel.h"
+
+// Standard includes
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define DAE_TRANSFORM_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace dae::transform_kernel_detail
+{
+#if defined(DAE_TRANSFORM_KERNEL_X86)
+    // Cephes single precision sin and cos over the same range reduction, accurate for |x| up to a few thousand
+    template <typename ops>
+    void sincos(typename ops::vf x, typename ops::vf &sin_out, typename ops::vf &cos_out)
+    {
+        using vf = typename ops::vf;
+        using vi = typename ops::vi;
+
+        vf const sign_mask = ops::set1(-0.0f);
+        vf       sign_sin  = ops::bit_and(x, sign_mask);
+        x = ops::bit_andnot(sign_mask, x);
+
+        // octant of x, rounded up to even so the reduced argument lands in [-pi/4, pi/4]
+        vi octant = ops::to_int(ops::mul(x, ops::set1(1.27323954473516f)));
+        octant    = ops::iand(ops::iadd(octant, ops::iset1(1)), ops::iset1(~1));
+        vf const y = ops::to_float(octant);
+
+        vf const swap_sign_sin = ops::as_float(ops::islli29(ops::iand(octant, ops::iset1(4))));
+        vf const sign_cos      = ops::as_float(ops::islli29(ops::iandnot(ops::isub(octant, ops::iset1(2)), ops::iset1(4))));
+        vf const use_cos_poly  = ops::as_float(ops::icmpeq(ops::iand(octant, ops::iset1(2)), ops::iset1(0)));
+        sign_sin = ops::bit_xor(sign_sin, swap_sign_sin);
+
+        // extended precision modular arithmetic, x - y * pi / 4
+        x = ops::sub(x, ops::mul(y, ops::set1(0.78515625f)));
+        x = ops::sub(x, ops::mul(y, ops::set1(2.4187564849853515625e-4f)));
+        x = ops::sub(x, ops::mul(y, ops::set1(3.77489497744594108e-8f)));
+
+        vf const z = ops::mul(x, x);
+
+        vf cos_poly = ops::set1(2.443315711809948e-5f);
+        cos_poly = ops::add(ops::mul(cos_poly, z), ops::set1(-1.388731625493765e-3f));
+        cos_poly = ops::add(ops::mul(cos_poly, z), ops::set1(4.166664568298827e-2f));
+        cos_poly = ops::mul(ops::mul(cos_poly, z), z);
+        cos_poly = ops::sub(cos_poly, ops::mul(z, ops::set1(0.5f)));
+        cos_poly = ops::add(cos_poly, ops::set1(1.0f));
+
+        vf sin_poly = ops::set1(-1.9515295891e-4f);
+        sin_poly = ops::add(ops::mul(sin_poly, z), ops::set1(8.3321608736e-3f));
+        sin_poly = ops::add(ops::mul(sin_poly, z), ops::set1(-1.6666654611e-1f));
+        sin_poly = ops::add(ops::mul(ops::mul(sin_poly, z), x), x);
+
+        vf const sin_value = ops::bit_or(ops::bit_and(use_cos_poly, sin_poly), ops::bit_andnot(use_cos_poly, cos_poly));
+        vf const cos_value = ops::bit_or(ops::bit_and(use_cos_poly, cos_poly), ops::bit_andnot(use_cos_poly, sin_poly));
+        sin_out = ops::bit_xor(sin_value, sign_sin);
+        cos_out = ops::bit_xor(cos_value, sign_cos);
+    }
+
+    // Full groups of ops::width transforms, returns how many were written. Matrix elements are kept one vector per
+    // element across the group and transposed into per-transform columns on store.
+    template <typename ops>
+    auto compose(transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices) -> size_t
+    {
+        using vf = typename ops::vf;
+
+        vf const zero = ops::set1(0.0f);
+        vf const one  = ops::set1(1.0f);
+
+        size_t i = 0;
+        for (; i + ops::width <= count; i += ops::width)
+        {
+            vf s1, c1, s2, c2, s3, c3;
+            sincos<ops>(ops::load(input.rotation_y + i), s1, c1);
+            sincos<ops>(ops::load(input.rotation_x + i), s2, c2);
+            sincos<ops>(ops::load(input.rotation_z + i), s3, c3);
+
+            // same products in the same order as the scalar reference
+            vf const r00 = ops::add(ops::mul(c1, c3), ops::mul(ops::mul(s1, s2), s3));
+            vf const r01 = ops::mul(c2, s3);
+            vf const r02 = ops::sub(ops::mul(ops::mul(c1, s2), s3), ops::mul(c3, s1));
+            vf const r10 = ops::sub(ops::mul(ops::mul(c3, s1), s2), ops::mul(c1, s3));
+            vf const r11 = ops::mul(c2, c3);
+            vf const r12 = ops::add(ops::mul(ops::mul(c1, c3), s2), ops::mul(s1, s3));
+            vf const r20 = ops::mul(c2, s1);
+            vf const r21 = ops::bit_xor(s2, ops::set1(-0.0f));
+            vf const r22 = ops::mul(c1, c2);
+
+            vf const sx = ops::load(input.scale_x + i);
+            vf const sy = ops::load(input.scale_y + i);
+            vf const sz = ops::load(input.scale_z + i);
+
+            vf const world[16] = {
+                ops::mul(sx, r00), ops::mul(sx, r01), ops::mul(sx, r02), zero,
+                ops::mul(sy, r10), ops::mul(sy, r11), ops::mul(sy, r12), zero,
+                ops::mul(sz, r20), ops::mul(sz, r21), ops::mul(sz, r22), zero,
+                ops::load(input.translation_x + i), ops::load(input.translation_y + i), ops::load(input.translation_z + i), one,
+            };
+            ops::store_matrices(world, reinterpret_cast<float *>(world_matrices + i));
+
+            vf const ix = ops::div(one, sx);
+            vf const iy = ops::div(one, sy);
+            vf const iz = ops::div(one, sz);
+
+            vf const normal[16] = {
+                ops::mul(ix, r00), ops::mul(ix, r01), ops::mul(ix, r02), zero,
+                ops::mul(iy, r10), ops::mul(iy, r11), ops::mul(iy, r12), zero,
+                ops::mul(iz, r20), ops::mul(iz, r21), ops::mul(iz, r22), zero,
+                zero, zero, zero, one,
+            };
+            ops::store_matrices(normal, reinterpret_cast<float *>(normal_matrices + i));
+        }
+        return i;
+    }
+
+    auto compose_sse2(transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices) -> size_t;
+    auto compose_avx2(transform_soa const &input, size_t count, glm::mat4 *world_matrices, glm::mat4 *normal_matrices) -> size_t;
+#endif
+}
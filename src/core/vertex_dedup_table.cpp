@@ -0,0 +1,123 @@
+﻿#include "vertex_dedup_table.h"
+
+// Standard includes
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace dae
+{
+    static_assert(offsetof(model::vertex, color) == offsetof(model::vertex, position) + sizeof(glm::vec3));
+    static_assert(offsetof(model::vertex, normal) == offsetof(model::vertex, color) + sizeof(glm::vec3));
+    static_assert(offsetof(model::vertex, uv) == offsetof(model::vertex, normal) + sizeof(glm::vec3));
+
+    namespace
+    {
+        // Grid cell of an attribute. Through double and clamped, so attributes far from the origin or not finite still
+        // convert without overflow, the extreme cells absorb them
+        auto quantize(float value, float weld_scale) -> int64_t
+        {
+            constexpr double limit = 0x1p62;
+            double const cell = std::floor(static_cast<double>(value) * weld_scale + 0.5);
+            return static_cast<int64_t>(cell > -limit ? std::min(cell, limit) : -limit);
+        }
+    }
+
+    vertex_dedup_table::vertex_dedup_table(std::vector<model::vertex> const &vertices, size_t max_vertices, float weld_epsilon)
+        : vertices_{vertices}
+        , weld_epsilon_{weld_epsilon}
+        , weld_scale_{weld_epsilon > 0.0f ? 1.0f / weld_epsilon : 0.0f}
+    {
+        // Keep the load factor at or below 2/3 even when every corner is unique
+        size_t const slot_count = std::bit_ceil(std::max<size_t>(16, max_vertices + max_vertices / 2));
+        slots_.resize(slot_count);
+        mask_ = slot_count - 1;
+    }
+
+    auto vertex_dedup_table::find_or_insert(model::vertex const &vertex, uint32_t new_index) -> uint32_t
+    {
+        uint32_t key[key_words];
+        make_key(vertex, key);
+
+        uint64_t const hash_value = hash(key);
+        auto const     tag        = static_cast<uint32_t>(hash_value >> 32);
+
+        for (size_t position = hash_value & mask_;; position = (position + 1) & mask_)
+        {
+            slot &slot = slots_[position];
+            if (slot.index == empty)
+            {
+                slot.tag   = tag;
+                slot.index = new_index;
+                return new_index;
+            }
+
+            if (slot.tag == tag and equal(vertices_[slot.index], vertex))
+            {
+                return slot.index;
+            }
+        }
+    }
+
+    void vertex_dedup_table::make_key(model::vertex const &vertex, uint32_t (&key)[key_words]) const
+    {
+        float attributes[key_words];
+        std::memcpy(attributes, &vertex.position, sizeof(attributes));
+
+        for (size_t i = 0; i < key_words; ++i)
+        {
+            if (weld_epsilon_ > 0.0f)
+            {
+                // Folded to 32 bits, which only costs the odd tag collision, equal compares the full cells
+                auto const cell = static_cast<uint64_t>(quantize(attributes[i], weld_scale_));
+                key[i] = static_cast<uint32_t>(cell) ^ static_cast<uint32_t>(cell >> 32);
+            }
+            else
+            {
+                // Adding +0 folds -0 into +0 so values that compare equal also hash equal
+                key[i] = std::bit_cast<uint32_t>(attributes[i] + 0.0f);
+            }
+        }
+    }
+
+    auto vertex_dedup_table::equal(model::vertex const &lhs, model::vertex const &rhs) const -> bool
+    {
+        if (weld_epsilon_ <= 0.0f)
+        {
+            return lhs == rhs;
+        }
+
+        float lhs_attributes[key_words];
+        float rhs_attributes[key_words];
+        std::memcpy(lhs_attributes, &lhs.position, sizeof(lhs_attributes));
+        std::memcpy(rhs_attributes, &rhs.position, sizeof(rhs_attributes));
+        for (size_t i = 0; i < key_words; ++i)
+        {
+            if (quantize(lhs_attributes[i], weld_scale_) != quantize(rhs_attributes[i], weld_scale_))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Single pass over the 44 key bytes, 64 bits at a time with a splitmix style finalizer
+    auto vertex_dedup_table::hash(uint32_t const (&key)[key_words]) -> uint64_t
+    {
+        uint64_t hash_value = 0x9E3779B97F4A7C15ull;
+        for (size_t i = 0; i + 1 < key_words; i += 2)
+        {
+            uint64_t const word = key[i] | (uint64_t{key[i + 1]} << 32);
+            hash_value = (hash_value ^ word) * 0xBF58476D1CE4E5B9ull;
+            hash_value ^= hash_value >> 31;
+        }
+
+        hash_value = (hash_value ^ key[key_words - 1]) * 0x94D049BB133111EBull;
+        hash_value ^= hash_value >> 29;
+        hash_value *= 0xBF58476D1CE4E5B9ull;
+        hash_value ^= hash_value >> 32;
+        return hash_value;
+    }
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+
+// Standard includes
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+    // Open-addressing vertex deduplication table, sized once from the number of corners so it never rehashes.
+    // Slots hold a hash tag and the vertex index, the vertices themselves stay in the builder's array.
+    // With a weld epsilon, vertices whose attributes quantize to the same grid cell are merged.
+    class vertex_dedup_table final
+    {
+    public:
+        vertex_dedup_table(std::vector<model::vertex> const &vertices, size_t max_vertices, float weld_epsilon = 0.0f);
+        ~vertex_dedup_table() = default;
+
+        vertex_dedup_table(vertex_dedup_table const &)            = delete;
+        vertex_dedup_table(vertex_dedup_table &&)                 = delete;
+        vertex_dedup_table &operator=(vertex_dedup_table const &) = delete;
+        vertex_dedup_table &operator=(vertex_dedup_table &&)      = delete;
+
+        // Returns the index of an equal vertex already in the table, or inserts new_index and returns it
+        auto find_or_insert(model::vertex const &vertex, uint32_t new_index) -> uint32_t;
+
+        [[nodiscard]] auto capacity() const -> size_t { return slots_.size(); }
+
+    private:
+        // position, color, normal and uv, the attributes vertex::operator== compares
+        static constexpr size_t key_words = 11;
+
+        static constexpr uint32_t empty = UINT32_MAX;
+
+        struct slot
+        {
+            uint32_t tag   = 0;
+            uint32_t index = empty;
+        };
+
+        void make_key(model::vertex const &vertex, uint32_t (&key)[key_words]) const;
+        auto equal(model::vertex const &lhs, model::vertex const &rhs) const -> bool;
+        static auto hash(uint32_t const (&key)[key_words]) -> uint64_t;
+
+        std::vector<model::vertex> const &vertices_;
+        std::vector<slot>                 slots_        = {};
+        size_t                            mask_         = 0;
+        float                             weld_epsilon_ = 0.0f;
+        float                             weld_scale_   = 0.0f;
+    };
+}
@@ -0,0 +1,282 @@
+﻿#include "asset_streamer.h"
+
+// Project includes
+#include "src/core/factory.h"
+#include "src/core/mesh_registry.h"
+#include "src/utility/utils.h"
+#include "src/vulkan/geometry_arena.h"
+
+// Standard includes
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace dae
+{
+    asset_streamer::asset_streamer()
+    {
+        // Constructed first so it outlives the placeholder and the models waiting for delivery
+        geometry_arena::instance();
+    }
+
+    asset_streamer::~asset_streamer()
+    {
+        stop();
+    }
+
+    void asset_streamer::start(uint32_t worker_count)
+    {
+        if (not workers_.empty())
+        {
+            return;
+        }
+
+        for (uint32_t i = 0; i < std::max(1u, worker_count); ++i)
+        {
+            workers_.emplace_back(&asset_streamer::worker_loop, this);
+        }
+    }
+
+    void asset_streamer::stop()
+    {
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        work_available_.notify_all();
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+        workers_.clear();
+
+        // The resources of the last commit are destroyed instead of delivered, but not while the device reads them
+        if (batch_)
+        {
+            batch_->wait();
+            batch_.reset();
+        }
+        committed_models_.clear();
+        committed_textures_.clear();
+        model_jobs_.clear();
+        queued_.clear();
+        loaded_.clear();
+        stats_.pending = 0;
+        stopping_      = false;
+    }
+
+    void asset_streamer::request_model(std::string const &file_path, model::vertex_layout layout, model_callback on_ready)
+    {
+        ++stats_.requests;
+        ++stats_.pending;
+
+        if (auto resident = mesh_registry::instance().find(file_path, layout))
+        {
+            // Possibly still uploading with the in-flight batch, delivered with it then
+            committed_models_.emplace_back(std::move(resident), std::move(on_ready));
+            if (not batch_)
+            {
+                deliver();
+            }
+            return;
+        }
+
+        if (auto const job_it = model_jobs_.find(file_path); job_it != model_jobs_.end())
+        {
+            job_it->second->model_requests.push_back({layout, std::move(on_ready)});
+            return;
+        }
+
+        auto new_job = std::make_unique<job>();
+        new_job->file_path = file_path;
+        new_job->model_requests.push_back({layout, std::move(on_ready)});
+        model_jobs_.emplace(file_path, new_job.get());
+        enqueue(std::move(new_job));
+    }
+
+    void asset_streamer::request_texture(std::string const &file_path, VkFormat format, texture_callback on_ready)
+    {
+        ++stats_.requests;
+        ++stats_.pending;
+
+        auto new_job = std::make_unique<job>();
+        new_job->file_path  = file_path;
+        new_job->format     = format;
+        new_job->on_texture = std::move(on_ready);
+        enqueue(std::move(new_job));
+    }
+
+    void asset_streamer::update()
+    {
+        if (batch_)
+        {
+            if (not batch_->is_complete())
+            {
+                return;
+            }
+            batch_->wait(); // only releases the staging buffers by now
+            batch_.reset();
+            deliver();
+        }
+
+        std::vector<std::unique_ptr<job>> ready{};
+        VkDeviceSize                      ready_bytes = 0;
+        {
+            std::lock_guard lock{mutex_};
+            while (not loaded_.empty() and (ready.empty() or ready_bytes + loaded_.front()->upload_bytes() <= frame_byte_budget))
+            {
+                ready_bytes += loaded_.front()->upload_bytes();
+                ready.push_back(std::move(loaded_.front()));
+                loaded_.pop_front();
+            }
+        }
+
+        for (auto const &ready_job : ready)
+        {
+            if (ready_job->is_model())
+            {
+                model_jobs_.erase(ready_job->file_path);
+            }
+
+            if (not ready_job->error.empty())
+            {
+                // The requests keep their placeholders
+                auto const request_count = ready_job->is_model() ? ready_job->model_requests.size() : size_t{1};
+                stats_.failed  += request_count;
+                stats_.pending -= request_count;
+                std::cerr << RED_TEXT("[Asset Streamer]\n") << ONE_TAB << ready_job->error << '\n';
+                continue;
+            }
+
+            if (not batch_)
+            {
+                batch_ = std::make_unique<upload_batch>();
+            }
+            commit(*ready_job);
+            stats_.committed_bytes += ready_job->upload_bytes();
+        }
+
+        if (batch_)
+        {
+            batch_->submit();
+            ++stats_.batches;
+        }
+    }
+
+    auto asset_streamer::placeholder_model() -> std::shared_ptr<model>
+    {
+        if (not placeholder_model_)
+        {
+            placeholder_model_ = factory::create_cube(placeholder_model_size);
+        }
+        return placeholder_model_;
+    }
+
+    auto asset_streamer::default_worker_count() -> uint32_t
+    {
+        // Leaves the render thread and the threads parallel_for spawns inside a parse some room
+        return std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    }
+
+    auto asset_streamer::job::upload_bytes() const -> VkDeviceSize
+    {
+        if (is_model())
+        {
+            return builder.vertices.size() * sizeof(model::vertex) + builder.indices.size() * sizeof(uint32_t);
+        }
+        return image.pixels.size();
+    }
+
+    void asset_streamer::enqueue(std::unique_ptr<job> job)
+    {
+        {
+            std::lock_guard lock{mutex_};
+            queued_.push_back(std::move(job));
+        }
+        work_available_.notify_one();
+    }
+
+    void asset_streamer::worker_loop()
+    {
+        while (true)
+        {
+            std::unique_ptr<job> current{};
+            {
+                std::unique_lock lock{mutex_};
+                work_available_.wait(lock, [this] { return stopping_ or not queued_.empty(); });
+                if (stopping_)
+                {
+                    return;
+                }
+                current = std::move(queued_.front());
+                queued_.pop_front();
+            }
+
+            // The render thread may still append requests to a model job, neither side touches the other's fields
+            try
+            {
+                if (current->format == VK_FORMAT_UNDEFINED)
+                {
+                    current->hash    = mesh_registry::content_hash(current->file_path);
+                    current->builder = model::load_builder(current->file_path);
+                }
+                else
+                {
+                    current->image = texture::load_image(current->file_path);
+                }
+            }
+            catch (std::exception const &e)
+            {
+                current->error = e.what();
+            }
+
+            std::lock_guard lock{mutex_};
+            loaded_.push_back(std::move(current));
+        }
+    }
+
+    void asset_streamer::commit(job &job)
+    {
+        if (not job.is_model())
+        {
+            committed_textures_.emplace_back(std::make_unique<texture>(job.image, job.format), std::move(job.on_texture));
+            return;
+        }
+
+        for (auto &request : job.model_requests)
+        {
+            auto resident = mesh_registry::instance().acquire(job.file_path, request.layout, job.hash, [&]
+            {
+                job.builder.layout = request.layout;
+                return std::make_shared<model>(job.builder);
+            });
+            committed_models_.emplace_back(std::move(resident), std::move(request.on_ready));
+        }
+    }
+
+    void asset_streamer::deliver()
+    {
+        for (auto &[resident, on_ready] : committed_models_)
+        {
+            on_ready(std::move(resident));
+        }
+        for (auto &[resident, on_ready] : committed_textures_)
+        {
+            on_ready(std::move(resident));
+        }
+
+        stats_.delivered += committed_models_.size() + committed_textures_.size();
+        stats_.pending   -= committed_models_.size() + committed_textures_.size();
+        committed_models_.clear();
+        committed_textures_.clear();
+
+#ifndef NDEBUG
+        if (stats_.pending == 0 and stats_.delivered > 0)
+        {
+            std::cout << YELLOW_TEXT("[Asset Streamer]\n") << ONE_TAB << stats_.delivered << " assets delivered in " << stats_.batches
+                      << " batches, " << stats_.committed_bytes / 1024 << " KiB" << '\n';
+        }
+#endif
+    }
+}
@@ -0,0 +1,130 @@
+﻿#pragma once
+
+// Project includes
+#include "src/core/model.h"
+#include "src/utility/singleton.h"
+#include "src/utility/texture.h"
+#include "src/vulkan/upload_batch.h"
+
+// Standard includes
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Vulkan includes
+#include <vulkan/vulkan.h>
+
+namespace dae
+{
+    // Loads models and textures on worker threads while the frame loop keeps drawing placeholders. Workers only do the
+    // CPU side, reading the mesh cache or parsing and decoding images, the geometry arena, the queues and upload batches
+    // stay on the render thread. update commits finished loads there at the frame boundary, at most frame_byte_budget
+    // per frame in one upload batch, and hands every asset to its requests once that batch's fence signalled.
+    class asset_streamer final : public singleton<asset_streamer>
+    {
+    public:
+        using model_callback   = std::function<void(std::shared_ptr<model>)>;
+        using texture_callback = std::function<void(std::unique_ptr<texture>)>;
+
+        struct statistics
+        {
+            uint64_t     requests        = 0;
+            uint64_t     delivered       = 0;
+            uint64_t     failed          = 0;
+            uint64_t     batches         = 0;
+            VkDeviceSize committed_bytes = 0;
+            uint64_t     pending         = 0; // requested but not delivered yet
+        };
+
+        ~asset_streamer() override;
+
+        asset_streamer(asset_streamer const &)            = delete;
+        asset_streamer(asset_streamer &&)                 = delete;
+        asset_streamer &operator=(asset_streamer const &) = delete;
+        asset_streamer &operator=(asset_streamer &&)      = delete;
+
+        // Requests made before start stay queued until the workers run
+        void start(uint32_t worker_count = default_worker_count());
+
+        // Joins the workers and drops whatever was not delivered, callbacks never run afterward
+        void stop();
+
+        // on_ready runs on the render thread from update, every layout of a path shares one parse
+        void request_model(std::string const &file_path, model::vertex_layout layout, model_callback on_ready);
+        void request_texture(std::string const &file_path, VkFormat format, texture_callback on_ready);
+
+        // Once per frame before recording, delivers the previous commit and commits the next loads
+        void update();
+
+        // Drawn in place of every streamed model until its own is delivered
+        [[nodiscard]] auto placeholder_model() -> std::shared_ptr<model>;
+
+        [[nodiscard]] auto stats() const -> statistics { return stats_; }
+
+        static auto default_worker_count() -> uint32_t;
+
+        // At least one load is committed per frame, so a single asset over the budget still gets through
+        static constexpr VkDeviceSize frame_byte_budget        = 8ull << 20;
+        static constexpr float        placeholder_model_size   = 1.0f;
+        static constexpr char const  *placeholder_texture_path = "assets/textures/debug.png";
+
+    private:
+        friend class singleton<asset_streamer>;
+        asset_streamer();
+
+        struct model_request
+        {
+            model::vertex_layout layout   = model::vertex_layout::full;
+            model_callback       on_ready = {};
+        };
+
+        // A model job covers every request for one file, a texture job a single request
+        struct job
+        {
+            std::string file_path = {};
+            std::string error     = {}; // set by the worker when loading threw
+
+            std::vector<model_request> model_requests = {};
+            model::builder             builder        = {};
+            uint64_t                   hash           = 0;
+
+            VkFormat            format     = VK_FORMAT_UNDEFINED;
+            texture_callback    on_texture = {};
+            texture::image_data image      = {};
+
+            [[nodiscard]] auto is_model() const -> bool { return not model_requests.empty(); }
+            [[nodiscard]] auto upload_bytes() const -> VkDeviceSize;
+        };
+
+        void enqueue(std::unique_ptr<job> job);
+        void worker_loop();
+        void commit(job &job);
+        void deliver();
+
+        std::vector<std::thread> workers_        = {};
+        std::mutex               mutex_          = {};
+        std::condition_variable  work_available_ = {};
+
+        // Guarded by mutex_
+        std::deque<std::unique_ptr<job>> queued_   = {};
+        std::deque<std::unique_ptr<job>> loaded_   = {};
+        bool                             stopping_ = false;
+
+        // Render thread only, model jobs stay findable by path until committed so later requests join them
+        std::map<std::string, job *> model_jobs_ = {};
+
+        std::unique_ptr<upload_batch>                                  batch_              = {};
+        std::vector<std::pair<std::shared_ptr<model>, model_callback>> committed_models_   = {};
+        std::vector<std::pair<std::unique_ptr<texture>, texture_callback>> committed_textures_ = {};
+
+        std::shared_ptr<model> placeholder_model_ = {};
+        statistics             stats_             = {};
+    };
+}
@@ -109,4 +109,25 @@ namespace dae
         inverse_view_matrix_[3][1] = position.y;
         inverse_view_matrix_[3][2] = position.z;
     }
+
+    auto camera::frustum_planes() const -> std::array<glm::vec4, 6>
+    {
+        return extract_frustum_planes(projection_matrix_ * view_matrix_);
+    }
+
+    auto camera::extract_frustum_planes(glm::mat4 const &clip) -> std::array<glm::vec4, 6>
+    {
+        // From the rows of the clip matrix, a point is inside where dot(plane, point) >= 0 for every plane
+        glm::vec4 const row0{clip[0][0], clip[1][0], clip[2][0], clip[3][0]};
+        glm::vec4 const row1{clip[0][1], clip[1][1], clip[2][1], clip[3][1]};
+        glm::vec4 const row2{clip[0][2], clip[1][2], clip[2][2], clip[3][2]};
+        glm::vec4 const row3{clip[0][3], clip[1][3], clip[2][3], clip[3][3]};
+
+        std::array<glm::vec4, 6> planes{row3 + row0, row3 - row0, row3 + row1, row3 - row1, row2, row3 - row2};
+        for (auto &plane : planes)
+        {
+            plane /= glm::length(glm::vec3{plane});
+        }
+        return planes;
+    }
 }
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+// Standard includes
+#include <array>
+
 // GLM includes
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -22,6 +25,12 @@ namespace dae
         [[nodiscard]] auto get_inverse_view() const -> glm::mat4 { return inverse_view_matrix_; }
         [[nodiscard]] auto get_position() const -> glm::vec3 { return glm::vec3{inverse_view_matrix_[3]}; }
 
+        // World space planes of the view frustum, xyz is the unit normal pointing inside and w the distance
+        [[nodiscard]] auto frustum_planes() const -> std::array<glm::vec4, 6>;
+
+        // Left, right, top, bottom, near and far planes of the space clip maps from, depth is clipped to [0, w]
+        static auto extract_frustum_planes(glm::mat4 const &clip) -> std::array<glm::vec4, 6>;
+
     private:
         glm::mat4 projection_matrix_   {1.0f};
         glm::mat4 view_matrix_         {1.0f};
@@ -2,6 +2,7 @@
 
 // Project includes
 #include "src/core/factory.h"
+#include "src/engine/asset_streamer.h"
 #include "src/engine/camera.h"
 #include "src/engine/frame_info.h"
 #include "src/engine/game_time.h"
@@ -12,13 +13,18 @@
 #include "src/system/render_2d_system.h"
 #include "src/system/render_3d_system.h"
 #include "src/system/texture_pbr_system.h"
+#include "src/utility/frame_arena.h"
 #include "src/utility/texture.h"
-#include "src/vulkan/buffer.h"
 #include "src/vulkan/device.h"
+#include "src/vulkan/frame_allocator.h"
+#include "src/vulkan/geometry_arena.h"
 #include "src/vulkan/renderer.h"
+#include "src/vulkan/upload_batch.h"
 
+#include <array>
 #include <chrono>
 #include <thread>
+#include <utility>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -43,31 +49,20 @@ namespace dae
         device_ptr_ = &device::instance();
         renderer_ptr_ = &renderer::instance();
 
-        global_pool_ = descriptor_pool::builder().set_max_sets(swap_chain::MAX_FRAMES_IN_FLIGHT).add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, swap_chain::MAX_FRAMES_IN_FLIGHT).add_pool_size(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, swap_chain::MAX_FRAMES_IN_FLIGHT)
+        // Constructed before the scenes so it outlives every model that frees its ranges on destruction
+        geometry_arena_ptr_ = &geometry_arena::instance();
+
+        // Holds the global ubo and per-object data of every frame in flight
+        frame_allocator_ptr_ = &frame_allocator::instance();
+
+        global_pool_ = descriptor_pool::builder().set_max_sets(swap_chain::MAX_FRAMES_IN_FLIGHT).add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, swap_chain::MAX_FRAMES_IN_FLIGHT).add_pool_size(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, swap_chain::MAX_FRAMES_IN_FLIGHT)
             .build();
     }
 
-    void engine::run(std::function<void()> const& load)
+    void engine::run(std::function<void()> const& load, frame_callback const& on_frame)
     {
 
 
-        std::vector<std::unique_ptr<buffer>> ubo_buffers(swap_chain::MAX_FRAMES_IN_FLIGHT);
-
-        //ubo 
-        for (int i = 0; i < ubo_buffers.size(); ++i)
-        {
-            ubo_buffers[i] = std::make_unique<buffer>(
-                sizeof(global_ubo),
-                1,
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-            );
-            ubo_buffers[i]->map();
-        }
-
-
-
-
 
         //build descriptor set layout 
 
@@ -79,7 +74,8 @@ namespace dae
 
         //first is a uniform buffer 
         //2 patrameters type of resorice bound and that spot and ,which sahder stages can acces this binding 
-        Builder.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS);
+        //the ubo is allocated from the frame allocator every frame, so it is bound with frame_info.global_ubo_offset
+        Builder.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_ALL_GRAPHICS);
         Builder.add_binding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
         Builder.add_binding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
         Builder.add_binding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -106,13 +102,48 @@ namespace dae
         //create game objects //and create models load vertex and index buffers 
         load();
 
-        // textures
+        // textures, bound to 1 through 5 of the global set
+        auto const &loader = scene_loader::instance();
+        std::array<std::pair<std::string, VkFormat>, 5> const texture_sources{{
+            {loader.diffuse_texture_path(), VK_FORMAT_R8G8B8A8_SRGB},
+            {loader.normal_texture_path(), VK_FORMAT_R8G8B8A8_UNORM},
+            {loader.specular_texture_path(), VK_FORMAT_R8G8B8A8_SRGB},
+            {loader.glossiness_texture_path(), VK_FORMAT_R8G8B8A8_SRGB},
+            {loader.texture_path(), VK_FORMAT_R8G8B8A8_SRGB},
+        }};
+        std::array<std::unique_ptr<texture>, 5> textures{};
+
+        // uploaded in one batch that executes while the descriptor sets are written
+        upload_batch texture_batch{};
+
+        // when streaming every binding samples the debug texture until its own texture is delivered, each delivery
+        // bumps the generation and every frame rewrites its set once it sees a newer one
+        std::unique_ptr<texture> placeholder_texture{};
+        uint32_t texture_generation = 0;
+        std::vector<uint32_t> written_texture_generations(swap_chain::MAX_FRAMES_IN_FLIGHT, 0);
+
+        if (loader.streaming())
+        {
+            placeholder_texture = std::make_unique<texture>(asset_streamer::placeholder_texture_path, VK_FORMAT_R8G8B8A8_SRGB);
+            for (size_t slot = 0; slot < textures.size(); ++slot)
+            {
+                asset_streamer::instance().request_texture(texture_sources[slot].first, texture_sources[slot].second,
+                    [&textures, &texture_generation, slot](std::unique_ptr<texture> loaded)
+                    {
+                        textures[slot] = std::move(loaded);
+                        ++texture_generation;
+                    });
+            }
+        }
+        else
+        {
+            for (size_t slot = 0; slot < textures.size(); ++slot)
+            {
+                textures[slot] = std::make_unique<texture>(texture_sources[slot].first, texture_sources[slot].second);
+            }
+        }
 
-        texture diffuse_texture{ scene_loader::instance().diffuse_texture_path(), VK_FORMAT_R8G8B8A8_SRGB };
-        texture normal_texture{ scene_loader::instance().normal_texture_path(), VK_FORMAT_R8G8B8A8_UNORM };
-        texture specular_texture{ scene_loader::instance().specular_texture_path(), VK_FORMAT_R8G8B8A8_SRGB };
-        texture gloss_texture{ scene_loader::instance().glossiness_texture_path(), VK_FORMAT_R8G8B8A8_SRGB };
-        texture texture{ scene_loader::instance().texture_path(), VK_FORMAT_R8G8B8A8_SRGB };
+        texture_batch.submit();
 
 
 
@@ -126,44 +157,15 @@ namespace dae
 
 
 
-        //descriptor set image of each texture 
-        VkDescriptorImageInfo diffuse_image_info{};
-        diffuse_image_info.sampler = diffuse_texture.sampler();
-        diffuse_image_info.imageView = diffuse_texture.image_view();
-        diffuse_image_info.imageLayout = diffuse_texture.image_layout();
-
-        VkDescriptorImageInfo normal_image_info{};
-        normal_image_info.sampler = normal_texture.sampler();
-        normal_image_info.imageView = normal_texture.image_view();
-        normal_image_info.imageLayout = normal_texture.image_layout();
-
-        VkDescriptorImageInfo specular_image_info{};
-        specular_image_info.sampler = specular_texture.sampler();
-        specular_image_info.imageView = specular_texture.image_view();
-        specular_image_info.imageLayout = specular_texture.image_layout();
-
-        VkDescriptorImageInfo emission_image_info{};
-        emission_image_info.sampler = gloss_texture.sampler();
-        emission_image_info.imageView = gloss_texture.image_view();
-        emission_image_info.imageLayout = gloss_texture.image_layout();
-
-        VkDescriptorImageInfo texture_image_info{};
-        texture_image_info.sampler = texture.sampler();
-        texture_image_info.imageView = texture.image_view();
-        texture_image_info.imageLayout = texture.image_layout();
-
-
-
         //Creating descriptor sets for each frame
 
 
         std::vector<VkDescriptorSet> global_descriptor_sets(swap_chain::MAX_FRAMES_IN_FLIGHT);
 
-        for (int i = 0; i < global_descriptor_sets.size(); ++i)
+        auto const write_global_descriptor_set = [&](size_t frame, bool allocate)
         {
-
             //buffer info 
-            auto buffer_info = ubo_buffers[i]->descriptor_info();
+            auto buffer_info = frame_allocator_ptr_->descriptor_info(static_cast<int>(frame), sizeof(global_ubo));
 
 
            // VkDescriptorBufferInfo
@@ -176,22 +178,40 @@ namespace dae
 
 
 
-            descriptor_writer(global_set_layout.get(), global_pool_.get())
-                .write_buffer(0, &buffer_info)  //binds UBO 
-                .write_image(1, &diffuse_image_info)
-                .write_image(2, &normal_image_info)
-                .write_image(3, &specular_image_info)
-                .write_image(4, &emission_image_info)
-                .write_image(5, &texture_image_info)
-                .build(global_descriptor_sets[i]);
+            //descriptor set image of each texture 
+            std::array<VkDescriptorImageInfo, 5> image_infos{};
+            descriptor_writer writer{global_set_layout.get(), global_pool_.get()};
+            writer.write_buffer(0, &buffer_info); //binds UBO 
+            for (size_t slot = 0; slot < textures.size(); ++slot)
+            {
+                texture const &bound = textures[slot] ? *textures[slot] : *placeholder_texture;
+                image_infos[slot].sampler = bound.sampler();
+                image_infos[slot].imageView = bound.image_view();
+                image_infos[slot].imageLayout = bound.image_layout();
+                writer.write_image(static_cast<uint32_t>(slot + 1), &image_infos[slot]);
+            }
+
             // Actually allocates the descriptor set and updates it with all these bindings.
+            if (allocate)
+            {
+                writer.build(global_descriptor_sets[frame]);
+            }
+            else
+            {
+                writer.overwrite(global_descriptor_sets[frame]);
+            }
+        };
+
+        for (int i = 0; i < global_descriptor_sets.size(); ++i)
+        {
+            write_global_descriptor_set(i, true);
         }
 
         camera camera{};
         
-        auto viewer_object = game_object("viewer");
-        viewer_object.transform.translation = { 0.0f, -1.5f, -5.0f };
-        viewer_object.transform.rotation = { -0.2f, 0.0f, 0.0f };
+        transform_component viewer_transform{};
+        viewer_transform.set_translation({ 0.0f, -1.5f, -5.0f });
+        viewer_transform.set_rotation({ -0.2f, 0.0f, 0.0f });
         movement_controller camera_controller = {};
 
         // register input callbacks
@@ -200,6 +220,8 @@ namespace dae
         // ubo and frame info
         global_ubo ubo{};
 
+        texture_batch.wait();
+
 
         auto & frame_info = frame_info::instance();
 
@@ -208,9 +230,13 @@ namespace dae
         using namespace std::chrono_literals;
         auto last_time = high_resolution_clock::now();
         float lag = 0.0f;
+        uint64_t frame_count = 0;
 
         while (not window_ptr_->should_close())
         {
+            // nothing from the previous frame's scratch memory is used anymore
+            frame_arena::instance().reset();
+
             glfwPollEvents();
 
             auto current_time = high_resolution_clock::now();
@@ -223,8 +249,8 @@ namespace dae
 
 
             // camera
-            camera_controller.move(window_ptr_->get_glfw_window(), viewer_object);
-            camera.set_view_yxz(viewer_object.transform.translation, viewer_object.transform.rotation);
+            camera_controller.move(window_ptr_->get_glfw_window(), viewer_transform);
+            camera.set_view_yxz(viewer_transform.translation(), viewer_transform.rotation());
 
             float aspect = renderer_ptr_->aspect_ratio();
             camera.set_orthographic_projection(-aspect, aspect, -1, 1, -1, 1);
@@ -232,10 +258,29 @@ namespace dae
 
 
 
+            // soft budget callbacks and the periodic memory report
+            device_ptr_->budget().update(game_time::instance().delta_time());
+
+            // streamed assets replace their placeholders between frames
+            if (loader.streaming())
+            {
+                asset_streamer::instance().update();
+            }
+
             if (auto command_buffer = renderer_ptr_->begin_frame())
             {
                 int frame_index = renderer_ptr_->frame_index();
 
+                // the frame's fence signalled inside begin_frame, so its per-frame data can be overwritten
+                frame_allocator_ptr_->begin_frame(frame_index);
+
+                // the frame's previous submission finished, so its set can pick up newly delivered textures
+                if (written_texture_generations[frame_index] != texture_generation)
+                {
+                    write_global_descriptor_set(frame_index, false);
+                    written_texture_generations[frame_index] = texture_generation;
+                }
+
                 // frame info
                 frame_info.frame_index = frame_index;
                 frame_info.command_buffer = command_buffer;
@@ -253,8 +298,7 @@ namespace dae
                 // update all scenes 
                 scene_manager.update();
                 
-                ubo_buffers[frame_index]->write_to_buffer(&ubo);
-                ubo_buffers[frame_index]->flush();
+                frame_info.global_ubo_offset = frame_allocator_ptr_->push(ubo);
 
                 // render
                 renderer_ptr_->begin_swap_chain_render_pass(command_buffer);
@@ -262,10 +306,24 @@ namespace dae
                 renderer_ptr_->end_swap_chain_render_pass(command_buffer);
                 renderer_ptr_->end_frame();
 
+                // the counters of the frame just recorded
+                scene_manager.update_culling_report(game_time::instance().delta_time());
+
+                if (on_frame and not on_frame(++frame_count))
+                {
+                    break;
+                }
+
                 auto const sleep_time = current_time + milliseconds(static_cast<long long>(game_time::instance().ms_per_frame())) - high_resolution_clock::now();
                 std::this_thread::sleep_for(sleep_time);
             }
         }
         vkDeviceWaitIdle(device_ptr_->logical_device());
+
+        // the delivery callbacks point into this frame loop
+        if (loader.streaming())
+        {
+            asset_streamer::instance().stop();
+        }
     }
 }
@@ -1,10 +1,11 @@
 ﻿#pragma once
 
 // Project includes
-#include "src/core/game_object.h"
+#include "src/core/components.h"
 #include "src/vulkan/descriptors.h"
 
 // Standard includes
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -14,6 +15,8 @@ namespace dae
     // Forward declarations
     class window;
     class device;
+    class frame_allocator;
+    class geometry_arena;
     class renderer;
     
     class engine final
@@ -27,12 +30,17 @@ namespace dae
         engine &operator=(engine const &other) = delete;
         engine &operator=(engine &&other)      = delete;
 
-        void run(std::function<void()> const & load);
+        // Called after every recorded frame with the number of frames so far, the loop ends once it returns false
+        using frame_callback = std::function<bool(uint64_t frame_count)>;
+
+        void run(std::function<void()> const & load, frame_callback const & on_frame = {});
 
     private:
-        window   * window_ptr_   = nullptr;
-        device   * device_ptr_   = nullptr;
-        renderer * renderer_ptr_ = nullptr;
+        window         * window_ptr_         = nullptr;
+        device         * device_ptr_         = nullptr;
+        renderer       * renderer_ptr_       = nullptr;
+        geometry_arena * geometry_arena_ptr_ = nullptr;
+        frame_allocator * frame_allocator_ptr_ = nullptr;
         
         std::unique_ptr<descriptor_pool> global_pool_{};
 
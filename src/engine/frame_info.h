@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 // Project includes
-#include "src/core/game_object.h"
+#include "src/core/component_store.h"
 #include "src/engine/camera.h"
 
 // Vulkan includes
@@ -39,12 +39,13 @@ namespace dae
         frame_info &operator=(frame_info const &other) = delete;
         frame_info &operator=(frame_info &&other)      = delete;
         
-        int                       frame_index;
-        VkCommandBuffer           command_buffer;
-        camera                    *camera_ptr;
-        VkDescriptorSet           global_descriptor_set;
-        std::vector<game_object*> game_objects;
-        global_ubo                *ubo_ptr;
+        int                           frame_index;
+        VkCommandBuffer               command_buffer;
+        camera                        *camera_ptr;
+        VkDescriptorSet               global_descriptor_set;
+        uint32_t                      global_ubo_offset; // dynamic offset of the ubo in the global set
+        component_store               *components; // of the scene being updated or rendered
+        global_ubo                    *ubo_ptr;
         bool use_normal   = true;
         int  shading_mode = 3;
         
@@ -1,7 +1,6 @@
 ﻿#include "scene.h"
 
 // Project includes
-#include "src/core/game_object.h"
 #include "src/engine/frame_info.h"
 #include "src/system/i_system.h"
 
@@ -25,32 +24,25 @@ namespace dae
     {
         auto & frame = frame_info::instance();
 
-        frame.game_objects = objects();
+        frame.components = &components_;
         system_->update();
     }
 
-    void scene::render() const
+    void scene::render()
     {
         auto & frame = frame_info::instance();
-        frame.game_objects = objects();
+        frame.components = &components_;
+
+        // after every scene updated, so everything moved this frame is drawn where it ended up
+        components_.update_transforms();
         system_->render();
     }
 
-    auto scene::create_game_object(std::string const &name) -> game_object *
-    {
-        objects_.emplace_back(std::make_unique<game_object>(name));
-        return objects_.back().get();
-    }
-    
-    auto scene::objects() const -> std::vector<game_object*>
+    auto scene::create_game_object(std::string const &name) -> game_object
     {
-        std::vector<game_object*> objects;
-        objects.reserve(objects_.size());
-
-        for (auto const & object : objects_)
-        {
-            objects.push_back(object.get());
-        }
-        return objects;
+        auto const id = components_.create();
+        components_.names().emplace(id, name);
+        components_.transforms().emplace(id);
+        return game_object{components_, id};
     }
 }
@@ -1,17 +1,16 @@
 ﻿#pragma once
 
 // Project includes
+#include "src/core/component_store.h"
 #include "src/core/game_object.h"
 
 // Standard includes
 #include <memory>
 #include <string>
-#include <vector>
 
 namespace dae
 {
     // Forward declarations
-    class game_object;
     class scene_manager;
     class i_system;
 
@@ -30,19 +29,20 @@ namespace dae
         scene &operator=(scene &&other)      = delete;
 
         void update();
-        void render() const;
+        void render();
 
         [[nodiscard]] auto name() const -> std::string const & { return name_; }
 
-        auto create_game_object(std::string const &name = "new_game_object") -> game_object *;
-        [[nodiscard]] auto objects() const -> std::vector<game_object*>;
+        // Every object has a name and a transform, the other components are added through the handle
+        auto create_game_object(std::string const &name = "new_game_object") -> game_object;
+        [[nodiscard]] auto components() -> component_store & { return components_; }
 
     private:
         scene();
         explicit scene(std::string name, std::unique_ptr<i_system> system);
 
         std::string name_;
-        std::vector<std::unique_ptr<game_object>> objects_{};
+        component_store components_{};
         std::unique_ptr<i_system> system_{};
     };
 }
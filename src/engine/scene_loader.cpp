@@ -2,44 +2,126 @@
 
 // Project includes
 #include "src/core/factory.h"
+#include "src/core/mesh_registry.h"
+#include "src/engine/asset_streamer.h"
 #include "src/engine/scene.h"
 #include "src/engine/scene_config_manager.h"
 #include "src/engine/scene_manager.h"
+#include "src/utility/utils.h"
+#include "src/vulkan/device.h"
+#include "src/vulkan/upload_batch.h"
+
+// Standard includes
+#include <iostream>
 
 namespace dae
 {
     void scene_loader::load_scenes()
     {
+        auto const &scene_config = scene_config_manager::instance().scene_config();
+        if (scene_config.contains("staging_ring_mib"))
+        {
+            device::instance().set_staging_capacity(scene_config["staging_ring_mib"].get<VkDeviceSize>() << 20);
+        }
+
+        // Soft budgets only warn for now, a category over budget is where streamed assets would get evicted
+        if (scene_config.contains("memory_budgets_mib"))
+        {
+            for (auto const &[name, mib] : scene_config["memory_budgets_mib"].items())
+            {
+                for (size_t i = 0; i < memory_budget::category_count; ++i)
+                {
+                    auto const category = static_cast<memory_category>(i);
+                    if (name != memory_budget::category_name(category))
+                    {
+                        continue;
+                    }
+
+                    device::instance().budget().set_soft_budget(category, mib.get<VkDeviceSize>() << 20,
+                        [](memory_category over, VkDeviceSize bytes, VkDeviceSize soft_budget)
+                        {
+                            std::cerr << RED_TEXT("[Memory Budget]\n") << ONE_TAB << memory_budget::category_name(over) << " uses "
+                                      << (bytes >> 20) << " MiB, over its " << (soft_budget >> 20) << " MiB budget" << '\n';
+                        });
+                }
+            }
+        }
+        if (scene_config.contains("memory_report"))
+        {
+            auto const &report = scene_config["memory_report"];
+            device::instance().budget().set_report(report.value("interval_seconds", 0.0f), report.value("file", std::string{}));
+        }
+        if (scene_config.contains("culling_report"))
+        {
+            scene_manager::instance().set_culling_report(scene_config["culling_report"].value("interval_seconds", 0.0f));
+        }
+
+        streaming_ = scene_config.contains("streaming") and scene_config["streaming"].get<bool>();
+        if (streaming_)
+        {
+            asset_streamer::instance().start();
+        }
+
+        // Every model upload of every scene goes out in a single submission, with streaming only the procedural ones
+        upload_batch batch{};
+
         load_2d_scene();
         load_3d_scene();
         load_light_scene();
         load_material_pbr_scene();
         load_texture_pbr_scene();
+
+        batch.submit();
+        batch.wait();
+
+#ifndef NDEBUG
+        std::cout << YELLOW_TEXT("[Upload Batch]\n") << ONE_TAB << batch.recorded_commands() << " uploads in one submission" << '\n';
+
+        auto const staging = device::instance().staging().stats();
+        std::cout << YELLOW_TEXT("[Staging Ring]\n") << ONE_TAB << staging.ring_allocations << " uploads through the "
+                  << (staging.capacity >> 20) << " MiB ring, " << staging.dedicated_allocations << " dedicated, "
+                  << staging.fence_waits << " fence waits" << '\n'
+                  << ONE_TAB << 1 + staging.dedicated_allocations << " staging memory allocations instead of "
+                  << staging.ring_allocations + staging.dedicated_allocations << '\n';
+
+        auto const memory = device::instance().memory().stats();
+        std::cout << YELLOW_TEXT("[Memory Allocator]\n") << ONE_TAB << memory.live_allocations << " allocations in "
+                  << memory.blocks << " blocks and " << memory.dedicated << " dedicated, " << memory.allocate_calls
+                  << " vkAllocateMemory calls" << '\n'
+                  << ONE_TAB << (memory.used_bytes >> 20) << " of " << (memory.reserved_bytes >> 20) << " MiB used, "
+                  << static_cast<int>(memory.fragmentation * 100.0f) << "% of the free space fragmented" << '\n';
+        device::instance().budget().log(device::instance().budget().current());
+
+        auto const stats = mesh_registry::instance().stats();
+        std::cout << YELLOW_TEXT("[Mesh Registry]\n") << ONE_TAB << stats.requests << " requests, " << stats.hits << " hits, "
+                  << stats.loads << " loads" << '\n'
+                  << ONE_TAB << stats.resident_models << " models resident, " << stats.resident_bytes / 1024 << " KiB" << '\n';
+#endif
     }
 
     void scene_loader::load_2d_scene()
     {
         auto scene_ptr = scene_manager::instance().find("2d"); //find scene
-        auto go_ptr = scene_ptr->create_game_object("oval");
+        auto go = scene_ptr->create_game_object("oval");
 
         //create game object 
 
 
 
-        go_ptr->model = factory::create_oval({}, 0.5f, 0.5f, 50);
-        go_ptr->transform.translation = {2.0f, -1.0f, 0.0f};
+        go.set_model(factory::create_oval({}, 0.5f, 0.5f, 50));
+        go.transform().set_translation({2.0f, -1.0f, 0.0f});
 
         scene_ptr = scene_manager::instance().find("2d");
         auto const & scene_config = scene_config_manager::instance().scene_config();
         
-        go_ptr = scene_ptr->create_game_object("oval");
-        go_ptr->model = factory::create_oval({}, 0.5f, 0.5f, 30);
-        go_ptr->transform.translation = {2.0f, -1.0f, 2.0f};
-        go_ptr->transform.rotation = {0.0f, 0.0f, glm::pi<float>() / 2.0f};
+        go = scene_ptr->create_game_object("oval");
+        go.set_model(factory::create_oval({}, 0.5f, 0.5f, 30));
+        go.transform().set_translation({2.0f, -1.0f, 2.0f});
+        go.transform().set_rotation({0.0f, 0.0f, glm::pi<float>() / 2.0f});
 
-        go_ptr = scene_ptr->create_game_object("ngon");
-        go_ptr->model = factory::create_n_gon({}, 0.5f, 3);
-        go_ptr->transform.translation = {-2.0f, -1.0f, 0.0f};
+        go = scene_ptr->create_game_object("ngon");
+        go.set_model(factory::create_n_gon({}, 0.5f, 3));
+        go.transform().set_translation({-2.0f, -1.0f, 0.0f});
 
         // 
         
@@ -48,42 +130,21 @@ namespace dae
 
 
         
-        for (auto const &object : scene_config["2d"])
+        load_objects(*scene_ptr, scene_config["2d"], [this](game_object go, json const &object)
         {
-            std::string name = object.contains("name") ? object["name"] : "game_object";
-            auto go_ptr = scene_ptr->create_game_object(name);
-            if (object.contains("transform"))
-            {
-                auto transform = object["transform"];
-
-                glm::vec3 position = transform.contains("position") ? glm::vec3{transform["position"][0], transform["position"][1], transform["position"][2]} : glm::vec3{0.0f};
-                glm::vec3 rotation = transform.contains("rotation") ? glm::vec3{transform["rotation"][0], transform["rotation"][1], transform["rotation"][2]} : glm::vec3{0.0f};
-                glm::vec3 scale = glm::vec3{1.0f};
-                if (transform.contains("scale"))
-                {
-                    if (transform["scale"].is_number())
-                    {
-                        scale = glm::vec3{transform["scale"]};
-                    }
-                    else if (transform["scale"].is_array())
-                    {
-                        scale = glm::vec3{transform["scale"][0], transform["scale"][1], transform["scale"][2]};
-                    }
-                }
-                go_ptr->transform.translation = position;
-                go_ptr->transform.rotation = rotation;
-                go_ptr->transform.scale = scale;
-            }
             if (object.contains("model"))
             {
-                go_ptr->model = model::create_model(object["model"]);
+                assign_model(go, object["model"]);
             }
             if (object.contains("texture"))
             {
                 texture_path_ = object["texture"];
-                go_ptr->use_texture = true;
+                if (auto *mesh = go.mesh())
+                {
+                    mesh->use_texture = true;
+                }
             }
-        }
+        });
     }
 
     void scene_loader::load_3d_scene()
@@ -91,36 +152,14 @@ namespace dae
         auto scene_ptr = scene_manager::instance().find("3d");
         auto const &scene_config = scene_config_manager::instance().scene_config();
         
-        for (auto const &object : scene_config["3d"])
+        load_objects(*scene_ptr, scene_config["3d"], [this](game_object go, json const &object)
         {
-            std::string name = object.contains("name") ? object["name"] : "game_object";
-            auto go_ptr = scene_ptr->create_game_object(name);
-            if (object.contains("transform"))
-            {
-                auto transform = object["transform"];
-                glm::vec3 position = transform.contains("position") ? glm::vec3{transform["position"][0], transform["position"][1], transform["position"][2]} : glm::vec3{0.0f};
-                glm::vec3 rotation = transform.contains("rotation") ? glm::vec3{transform["rotation"][0], transform["rotation"][1], transform["rotation"][2]} : glm::vec3{0.0f};
-                glm::vec3 scale = glm::vec3{1.0f};
-                if (transform.contains("scale"))
-                {
-                    if (transform["scale"].is_number())
-                    {
-                        scale = glm::vec3{transform["scale"]};
-                    }
-                    else if (transform["scale"].is_array())
-                    {
-                        scale = glm::vec3{transform["scale"][0], transform["scale"][1], transform["scale"][2]};
-                    }
-                }
-                go_ptr->transform.translation = position;
-                go_ptr->transform.rotation = rotation;
-                go_ptr->transform.scale = scale;
-            }
             if (object.contains("model"))
             {
-                go_ptr->model = model::create_model(object["model"]);
+                auto const layout = object.contains("vertex_layout") ? model::vertex_layout_from_string(object["vertex_layout"]) : model::vertex_layout::full;
+                assign_model(go, object["model"], layout);
             }
-        }
+        });
     }
 
     void scene_loader::load_light_scene()
@@ -138,17 +177,15 @@ namespace dae
 
         for (int i = 0; i < light_colors.size(); ++i)
         {
-            auto go_ptr = scene_ptr->create_game_object("point_light");
-            go_ptr->color = light_colors[i];
-            go_ptr->point_light = std::make_unique<point_light_component>();
-            go_ptr->point_light->light_intensity = 0.2f;
+            auto go = scene_ptr->create_game_object("point_light");
+            go.add_point_light(light_colors[i], 0.2f);
             auto rotate_light = glm::rotate(
                 glm::mat4{1.0f},
                 (i * glm::two_pi<float>()) / light_colors.size(),
                 {0.0f, -1.0f, 0.0f}
             );
-            go_ptr->transform.translation = glm::vec3{rotate_light * glm::vec4{-1.0f, -1.0f, 0.0f, 1.0f}};
-            go_ptr->transform.scale = glm::vec3{0.1f};
+            go.transform().set_translation(glm::vec3{rotate_light * glm::vec4{-1.0f, -1.0f, 0.0f, 1.0f}});
+            go.transform().set_scale(glm::vec3{0.1f});
         }
     }
 
@@ -157,40 +194,14 @@ namespace dae
         auto scene_ptr = scene_manager::instance().find("material_pbr");
         auto const &scene_config = scene_config_manager::instance().scene_config();
         
-        for (auto const & object : scene_config["material_pbr"])
+        load_objects(*scene_ptr, scene_config["material_pbr"], [this](game_object go, json const &object)
         {
-            std::string name = object.contains("name") ? object["name"] : "game_object";
-            auto go_ptr = scene_ptr->create_game_object(name);
-
-
-            if (object.contains("transform"))
-            {
-                auto transform = object["transform"];
-                glm::vec3 position = transform.contains("position") ? glm::vec3{transform["position"][0], transform["position"][1], transform["position"][2]} : glm::vec3{0.0f};
-                glm::vec3 rotation = transform.contains("rotation") ? glm::vec3{transform["rotation"][0], transform["rotation"][1], transform["rotation"][2]} : glm::vec3{0.0f};
-                glm::vec3 scale = glm::vec3{1.0f};
-                if (transform.contains("scale"))
-                {
-                    if (transform["scale"].is_number())
-                    {
-                        scale = glm::vec3{transform["scale"]};
-                    }
-                    else if (transform["scale"].is_array())
-                    {
-                        scale = glm::vec3{transform["scale"][0], transform["scale"][1], transform["scale"][2]};
-                    }
-                }
-                go_ptr->transform.translation = position;
-                go_ptr->transform.rotation = rotation;
-                go_ptr->transform.scale = scale;
-            }
             if (object.contains("model"))
             {
-                go_ptr->model = model::create_model(object["model"]);
+                auto const layout = object.contains("vertex_layout") ? model::vertex_layout_from_string(object["vertex_layout"]) : model::vertex_layout::full;
+                assign_model(go, object["model"], layout);
             }
 
-
-
             float r, g, b;
             r = g = b = 1.0f;
 
@@ -209,8 +220,8 @@ namespace dae
             }
             float metallic = object.contains("metallic") ? static_cast<float>(object["metallic"]) : 0.0f;
             float roughness = object.contains("roughness") ? static_cast<float>(object["roughness"]) : 0.0f;
-            go_ptr->set_material(r, g, b, metallic, roughness);
-        }
+            go.set_material(r, g, b, metallic, roughness);
+        });
     }
 
     void scene_loader::load_texture_pbr_scene()
@@ -218,34 +229,12 @@ namespace dae
         auto scene_ptr = scene_manager::instance().find("texture_pbr");
         auto const &scene_config = scene_config_manager::instance().scene_config();
         
-        for (auto const &object : scene_config["texture_pbr"])
+        load_objects(*scene_ptr, scene_config["texture_pbr"], [this](game_object go, json const &object)
         {
-            std::string name = object.contains("name") ? object["name"] : "game_object";
-            auto go_ptr = scene_ptr->create_game_object(name);
-            if (object.contains("transform"))
-            {
-                auto transform = object["transform"];
-                glm::vec3 position = transform.contains("position") ? glm::vec3{transform["position"][0], transform["position"][1], transform["position"][2]} : glm::vec3{0.0f};
-                glm::vec3 rotation = transform.contains("rotation") ? glm::vec3{transform["rotation"][0], transform["rotation"][1], transform["rotation"][2]} : glm::vec3{0.0f};
-                glm::vec3 scale = glm::vec3{1.0f};
-                if (transform.contains("scale"))
-                {
-                    if (transform["scale"].is_number())
-                    {
-                        scale = glm::vec3{transform["scale"]};
-                    }
-                    else if (transform["scale"].is_array())
-                    {
-                        scale = glm::vec3{transform["scale"][0], transform["scale"][1], transform["scale"][2]};
-                    }
-                }
-                go_ptr->transform.translation = position;
-                go_ptr->transform.rotation = rotation;
-                go_ptr->transform.scale = scale;
-            }
             if (object.contains("model"))
             {
-                go_ptr->model = model::create_model(object["model"]);
+                auto const layout = object.contains("vertex_layout") ? model::vertex_layout_from_string(object["vertex_layout"]) : model::vertex_layout::full;
+                assign_model(go, object["model"], layout);
             }
             if (object.contains("textures"))
             {
@@ -267,6 +256,61 @@ namespace dae
                     glossiness_texture_path_ = textures["glossiness"];
                 }
             }
+        });
+    }
+
+    void scene_loader::load_objects(scene &scene, json const &objects, object_loader const &load_object, game_object const *parent)
+    {
+        for (auto const &object : objects)
+        {
+            std::string name = object.contains("name") ? object["name"] : "game_object";
+            auto go = scene.create_game_object(name);
+            if (parent)
+            {
+                go.set_parent(*parent);
+            }
+            if (object.contains("transform"))
+            {
+                auto transform = object["transform"];
+                glm::vec3 position = transform.contains("position") ? glm::vec3{transform["position"][0], transform["position"][1], transform["position"][2]} : glm::vec3{0.0f};
+                glm::vec3 rotation = transform.contains("rotation") ? glm::vec3{transform["rotation"][0], transform["rotation"][1], transform["rotation"][2]} : glm::vec3{0.0f};
+                glm::vec3 scale = glm::vec3{1.0f};
+                if (transform.contains("scale"))
+                {
+                    if (transform["scale"].is_number())
+                    {
+                        scale = glm::vec3{transform["scale"]};
+                    }
+                    else if (transform["scale"].is_array())
+                    {
+                        scale = glm::vec3{transform["scale"][0], transform["scale"][1], transform["scale"][2]};
+                    }
+                }
+                go.transform().set_translation(position);
+                go.transform().set_rotation(rotation);
+                go.transform().set_scale(scale);
+            }
+            load_object(go, object);
+
+            // Children are described like the objects of the scene, their transforms relative to this one
+            if (object.contains("children"))
+            {
+                load_objects(scene, object["children"], load_object, &go);
+            }
         }
     }
+
+    void scene_loader::assign_model(game_object go, std::string const &file_path, model::vertex_layout layout)
+    {
+        if (not streaming_)
+        {
+            go.set_model(mesh_registry::instance().acquire(file_path, layout));
+            return;
+        }
+
+        // The handle points at the scene's component store, so it stays valid until the streamer stops
+        auto &streamer = asset_streamer::instance();
+        go.set_model(streamer.placeholder_model());
+        streamer.request_model(file_path, layout, [go](std::shared_ptr<model> loaded) { go.set_model(std::move(loaded)); });
+    }
 }
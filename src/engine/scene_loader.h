@@ -1,14 +1,21 @@
 ﻿#pragma once
 
 // Project includes
+#include "src/core/game_object.h"
+#include "src/core/model.h"
 #include "src/engine/engine.h"
+#include "src/engine/scene_config_manager.h"
 #include "src/utility/singleton.h"
 
 // Standard includes
+#include <functional>
 #include <string>
 
 namespace dae
 {
+    // Forward declarations
+    class scene;
+
     class scene_loader final : public singleton<scene_loader>
     {
     public:
@@ -26,6 +33,9 @@ namespace dae
         void load_material_pbr_scene();
         void load_texture_pbr_scene();
 
+        // Models and textures load in the background behind placeholders, off unless the scene config sets "streaming"
+        [[nodiscard]] auto streaming() const -> bool { return streaming_; }
+
         [[nodiscard]] auto texture_path() const -> std::string const & { return texture_path_; }
         [[nodiscard]] auto diffuse_texture_path() const -> std::string const & { return diffuse_texture_path_; }
         [[nodiscard]] auto normal_texture_path() const -> std::string const & { return normal_texture_path_; }
@@ -36,7 +46,17 @@ namespace dae
         friend class singleton<scene_loader>;
         scene_loader() = default;
 
+        using object_loader = std::function<void(game_object go, json const &object)>;
+
+        // Creates an object per entry with its name and transform, the rest of the entry goes to load_object. Entries
+        // of an object's "children" array are loaded the same way and parented to it.
+        void load_objects(scene &scene, json const &objects, object_loader const &load_object, game_object const *parent = nullptr);
+
+        void assign_model(game_object go, std::string const &file_path, model::vertex_layout layout = model::vertex_layout::full);
+
     private:
+        bool streaming_ = false;
+
         std::string const debug_texture_path_ = engine::data_path + "assets/textures/debug.png";
         std::string texture_path_             = debug_texture_path_;
         std::string diffuse_texture_path_     = debug_texture_path_;
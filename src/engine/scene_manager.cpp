@@ -2,8 +2,10 @@
 
 // Project includes
 #include "src/engine/scene.h"
+#include "src/utility/utils.h"
 
 // Standard includes
+#include <iostream>
 #include <ranges>
 
 namespace dae
@@ -28,6 +30,47 @@ namespace dae
         }
     }
 
+    void scene_manager::set_culling_report(float interval_seconds)
+    {
+        culling_report_interval_ = interval_seconds;
+        since_culling_report_    = 0.0f;
+    }
+
+    void scene_manager::update_culling_report(float delta_time)
+    {
+        if (culling_report_interval_ <= 0.0f)
+        {
+            return;
+        }
+
+        since_culling_report_ += delta_time;
+        if (since_culling_report_ >= culling_report_interval_)
+        {
+            since_culling_report_ = 0.0f;
+            log_culling_statistics();
+        }
+    }
+
+    void scene_manager::log_culling_statistics() const
+    {
+        std::cout << YELLOW_TEXT("[Culling Report]\n");
+        for (auto const & scene : scenes_)
+        {
+            auto const &objects  = scene->system_->culling_statistics();
+            auto const &meshlets = scene->system_->meshlet_statistics();
+
+            std::cout << ONE_TAB << GREEN_TEXT("" + scene->name() + "") << '\n'
+                      << TWO_TABS << "objects: " << objects.visible << " visible, " << objects.culled << " culled" << '\n';
+
+            // Only systems drawing models through a meshlet_culler test meshlets
+            if (meshlets.tested > 0)
+            {
+                std::cout << TWO_TABS << "meshlets: " << meshlets.tested << " tested, " << meshlets.frustum_culled << " outside the frustum, "
+                          << meshlets.backface_culled << " backfacing, " << meshlets.drawn << " drawn in " << meshlets.draw_calls << " draw calls" << '\n';
+            }
+        }
+    }
+
     auto scene_manager::find(std::string const &name) -> scene *
     {
         auto const it = std::ranges::find_if(scenes_, [&name](auto const &scene)
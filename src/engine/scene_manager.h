@@ -30,6 +30,10 @@ namespace dae
         void update();
         void render();
 
+        // Off until called, then every interval_seconds the culling counters of each scene's last frame are logged
+        void set_culling_report(float interval_seconds);
+        void update_culling_report(float delta_time);
+
         [[nodiscard]] auto find(std::string const &name) -> scene *;
 
         auto create_scene(std::string const &name, std::unique_ptr<i_system> system) -> scene *;
@@ -38,5 +42,11 @@ namespace dae
         scene_manager();
         
         std::vector<std::unique_ptr<scene>> scenes_;
+
+    private:
+        void log_culling_statistics() const;
+
+        float culling_report_interval_ = 0.0f;
+        float since_culling_report_    = 0.0f;
     };
 }
@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 // Project includes
-#include "src/core/game_object.h"
+#include "src/core/components.h"
 #include "src/engine/window.h"
 
 namespace dae
@@ -23,7 +23,7 @@ namespace dae
     class movement_controller final
     {
     public:
-        void move(GLFWwindow *window_ptr, game_object &game_object);
+        void move(GLFWwindow *window_ptr, transform_component &transform);
         
     private:
         float move_speed = 3.0f;
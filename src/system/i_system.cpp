@@ -3,6 +3,9 @@
 // Project includes
 #include "src/vulkan/device.h"
 
+// Standard includes
+#include <cassert>
+
 namespace dae
 {
     i_system::i_system()
@@ -14,4 +17,36 @@ namespace dae
     {
         vkDestroyPipelineLayout(device_ptr_->logical_device(), pipeline_layout_, nullptr);
     }
+
+    void i_system::set_packed_shaders(VkRenderPass render_pass, std::string const &vertex_file_path, std::string const &color_vertex_file_path, std::string const &fragment_file_path)
+    {
+        packed_render_pass_ = render_pass;
+        packed_shaders_     = {vertex_file_path, color_vertex_file_path, fragment_file_path};
+    }
+
+    auto i_system::pipeline_for(model::vertex_layout layout) -> pipeline &
+    {
+        if (layout == model::vertex_layout::full)
+        {
+            return *pipeline_;
+        }
+
+        auto &packed_pipeline = layout == model::vertex_layout::packed ? packed_pipeline_ : packed_color_pipeline_;
+        if (not packed_pipeline)
+        {
+            assert(not packed_shaders_.vertex_file_path.empty() and "System has no shaders for packed vertex layouts");
+
+            pipeline_config_info pipeline_config{};
+            pipeline::default_pipeline_config_info(pipeline_config);
+            pipeline_config.binding_descriptions   = model::packed_vertex::get_binding_description(layout);
+            pipeline_config.attribute_descriptions = model::packed_vertex::get_attribute_descriptions(layout);
+            pipeline_config.render_pass            = packed_render_pass_;
+            pipeline_config.pipeline_layout        = pipeline_layout_;
+            packed_pipeline = std::make_unique<pipeline>(
+                layout == model::vertex_layout::packed ? packed_shaders_.vertex_file_path : packed_shaders_.color_vertex_file_path,
+                packed_shaders_.fragment_file_path,
+                pipeline_config);
+        }
+        return *packed_pipeline;
+    }
 }
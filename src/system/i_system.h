@@ -1,10 +1,14 @@
 ﻿#pragma once
 
 // Project includes
+#include "src/core/frustum_culler.h"
+#include "src/core/meshlet_culler.h"
+#include "src/core/model.h"
 #include "src/vulkan/pipeline.h"
 
 // Standard includes
 #include <memory>
+#include <string>
 
 namespace dae
 {
@@ -24,14 +28,42 @@ namespace dae
         virtual void update() { }
         virtual void render() { }
 
+        // Meshlet culling counters of the last render call
+        [[nodiscard]] auto meshlet_statistics() const -> meshlet_culler::statistics const & { return meshlet_statistics_; }
+
+        // Objects drawn and skipped by frustum culling in the last render call
+        [[nodiscard]] auto culling_statistics() const -> frustum_culler::statistics const & { return culling_statistics_; }
+
     protected:
         virtual void create_pipeline_layout(VkDescriptorSetLayout global_set_layout) = 0;
         virtual void create_pipeline(VkRenderPass render_pass) = 0;
 
+        // Shader variants for the packed vertex layouts, their pipelines are created the first time a model uses them
+        void set_packed_shaders(VkRenderPass render_pass, std::string const &vertex_file_path, std::string const &color_vertex_file_path, std::string const &fragment_file_path);
+
+        // pipeline_ for vertex_layout::full, otherwise the packed variant sharing pipeline_layout_
+        auto pipeline_for(model::vertex_layout layout) -> pipeline &;
+
     protected:
         device                    * device_ptr_;
 
         std::unique_ptr<pipeline> pipeline_;
         VkPipelineLayout          pipeline_layout_ = VK_NULL_HANDLE;
+
+        meshlet_culler::statistics meshlet_statistics_ = {};
+        frustum_culler::statistics culling_statistics_ = {};
+
+    private:
+        struct packed_shaders
+        {
+            std::string vertex_file_path       = {};
+            std::string color_vertex_file_path = {};
+            std::string fragment_file_path     = {};
+        };
+
+        VkRenderPass              packed_render_pass_     = VK_NULL_HANDLE;
+        packed_shaders            packed_shaders_         = {};
+        std::unique_ptr<pipeline> packed_pipeline_        = nullptr;
+        std::unique_ptr<pipeline> packed_color_pipeline_  = nullptr;
     };
 }
@@ -3,6 +3,7 @@
 // Project includes
 #include "src/engine/frame_info.h"
 #include "src/vulkan/device.h"
+#include "src/vulkan/frame_allocator.h"
 #include "src/vulkan/renderer.h"
 
 // Standard includes
@@ -11,7 +12,8 @@
 
 namespace dae
 {
-    struct material_pbr_push_constant
+    // Set 1 of the material_pbr shaders, written to the frame allocator per object
+    struct material_pbr_object_data
     {
         glm::mat4 model_matrix{1.0f};
         glm::mat4 normal_matrix{1.0f};
@@ -21,6 +23,7 @@ namespace dae
         float metallic;
         float roughness;
     };
+    static_assert(sizeof(material_pbr_object_data) <= frame_allocator::object_range);
     
     material_pbr_system::material_pbr_system(VkDescriptorSetLayout global_set_layout)
     {
@@ -30,8 +33,14 @@ namespace dae
 
     void material_pbr_system::render()
     {
-        auto & frame_info = frame_info::instance();
+        auto &frame_info = frame_info::instance();
+        auto &frame_allocator = frame_allocator::instance();
         pipeline_->bind(frame_info.command_buffer);
+        auto         bound_layout = model::vertex_layout::full;
+        model const *bound_model  = nullptr;
+
+        // The pipelines draw both faces, so meshlets are only culled against the frustum
+        meshlet_culler culler{*frame_info.camera_ptr, false};
 
         vkCmdBindDescriptorSets(
             frame_info.command_buffer,
@@ -40,49 +49,72 @@ namespace dae
             0,
             1,
             &frame_info.global_descriptor_set,
-            0,
-            nullptr
+            1,
+            &frame_info.global_ubo_offset
         );
 
-        for (auto const &obj : frame_info.game_objects)
+        auto &transforms = frame_info.components->transforms();
+        auto &materials  = frame_info.components->materials();
+        auto const meshes   = frame_info.components->meshes().components();
+        auto const entities = frame_info.components->meshes().entities();
+
+        // Only what intersects the frustum is recorded
+        auto const visible = frustum_culler::cull(*frame_info.camera_ptr, *frame_info.components, culling_statistics_);
+        for (uint32_t const i : visible)
         {
-            material_pbr_push_constant push{};
-            push.model_matrix = obj->transform.mat4();
-            push.normal_matrix = obj->transform.normal_matrix();
-            push.r = obj->material().base_color.r;
-            push.g = obj->material().base_color.g;
-            push.b = obj->material().base_color.b;
-            push.metallic = obj->material().metallic;
-            push.roughness = obj->material().roughness;
-
-            vkCmdPushConstants(
+            model &mesh = *meshes[i].model;
+            transform_component const &transform = transforms.get(entities[i]);
+            material_component const &material = materials.get(entities[i]);
+
+            if (mesh.layout() != bound_layout)
+            {
+                bound_layout = mesh.layout();
+                pipeline_for(bound_layout).bind(frame_info.command_buffer);
+            }
+
+            glm::mat4 const &model_matrix = transform.mat4();
+            material_pbr_object_data object{};
+            object.model_matrix = model_matrix * mesh.dequantization_matrix();
+            object.normal_matrix = transform.normal_matrix();
+            object.r = material.base_color.r;
+            object.g = material.base_color.g;
+            object.b = material.base_color.b;
+            object.metallic = material.metallic;
+            object.roughness = material.roughness;
+
+            frame_allocator::allocation const slot = frame_allocator.push_object(object);
+            vkCmdBindDescriptorSets(
                 frame_info.command_buffer,
+                VK_PIPELINE_BIND_POINT_GRAPHICS,
                 pipeline_layout_,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(material_pbr_push_constant),
-                &push);
+                1,
+                1,
+                &slot.object_set,
+                1,
+                &slot.offset);
             
-            obj->model->bind(frame_info.command_buffer);
-            obj->model->draw(frame_info.command_buffer);
+            // Models suballocated from the same arena pools share their vertex and index buffers
+            if (bound_model == nullptr or not mesh.shares_bindings(*bound_model))
+            {
+                mesh.bind(frame_info.command_buffer);
+                bound_model = &mesh;
+            }
+            mesh.draw(frame_info.command_buffer, model_matrix, culler);
         }
+
+        meshlet_statistics_ = culler.stats();
     }
 
     void material_pbr_system::create_pipeline_layout(VkDescriptorSetLayout global_set_layout)
     {
-        VkPushConstantRange push_constant_range{};
-        push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        push_constant_range.offset     = 0;
-        push_constant_range.size       = sizeof(material_pbr_push_constant);
-        
-        std::vector<VkDescriptorSetLayout> descriptor_set_layouts{global_set_layout};
+        std::vector<VkDescriptorSetLayout> descriptor_set_layouts{global_set_layout, frame_allocator::instance().object_set_layout()};
         
         VkPipelineLayoutCreateInfo pipeline_layout_info{};
         pipeline_layout_info.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipeline_layout_info.setLayoutCount         = static_cast<uint32_t>(descriptor_set_layouts.size());
         pipeline_layout_info.pSetLayouts            = descriptor_set_layouts.data();
-        pipeline_layout_info.pushConstantRangeCount = 1;
-        pipeline_layout_info.pPushConstantRanges    = &push_constant_range;
+        pipeline_layout_info.pushConstantRangeCount = 0;
+        pipeline_layout_info.pPushConstantRanges    = nullptr;
 
         if (vkCreatePipelineLayout(device_ptr_->logical_device(), &pipeline_layout_info, nullptr, &pipeline_layout_) != VK_SUCCESS)
         {
@@ -102,5 +134,11 @@ namespace dae
             "shaders/material_pbr.vert.spv",
             "shaders/material_pbr.frag.spv",
             pipeline_config);
+
+        set_packed_shaders(
+            render_pass,
+            "shaders/material_pbr_packed.vert.spv",
+            "shaders/material_pbr_packed.vert.spv",
+            "shaders/material_pbr.frag.spv");
     }
 }
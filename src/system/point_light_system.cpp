@@ -3,13 +3,16 @@
 // Project includes
 #include "src/engine/frame_info.h"
 #include "src/engine/game_time.h"
+#include "src/utility/frame_arena.h"
 #include "src/vulkan/device.h"
 #include "src/vulkan/renderer.h"
 
 // Standard includes
+#include <algorithm>
 #include <array>
-#include <map>
+#include <functional>
 #include <ranges>
+#include <utility>
 #include <stdexcept>
 
 // GLM includes
@@ -44,17 +47,22 @@ namespace dae
             {0.0f, -1.0f, 0.0f}
         );
         
+        auto &transforms = frame_info.components->transforms();
+        auto const lights   = frame_info.components->point_lights().components();
+        auto const entities = frame_info.components->point_lights().entities();
+
         int light_index = 0;
-        for (auto &obj : frame_info.game_objects)
+        for (size_t i = 0; i < lights.size(); ++i)
         {
             assert(light_index < MAX_LIGHTS and "Point lights exceed maximum specified");
+            transform_component &transform = transforms.get(entities[i]);
 
             // update light position
-            obj->transform.translation = glm::vec3{rotate_light * glm::vec4{obj->transform.translation, 1.0f}};
+            transform.set_translation(glm::vec3{rotate_light * glm::vec4{transform.translation(), 1.0f}});
 
             // copy light to ubo
-            frame_info.ubo_ptr->point_lights[light_index].position = glm::vec4{obj->transform.translation, 1.0f};
-            frame_info.ubo_ptr->point_lights[light_index].color    = glm::vec4{obj->color, obj->point_light->light_intensity};
+            frame_info.ubo_ptr->point_lights[light_index].position = glm::vec4{transform.translation(), 1.0f};
+            frame_info.ubo_ptr->point_lights[light_index].color    = glm::vec4{lights[i].color, lights[i].light_intensity};
 
             ++light_index;
         }
@@ -64,13 +72,20 @@ namespace dae
 void point_light_system::render()
     {
         auto &frame_info = frame_info::instance();
-        std::map<float, game_object::id_t> sorted;
-        for (auto &go : frame_info.game_objects)
+
+        auto &transforms = frame_info.components->transforms();
+        auto const lights   = frame_info.components->point_lights().components();
+        auto const entities = frame_info.components->point_lights().entities();
+
+        // back to front for blending by dense index, lights at the same distance are all kept
+        auto sorted = frame_arena::instance().make_vector<std::pair<float, uint32_t>>(lights.size());
+        for (uint32_t i = 0; i < lights.size(); ++i)
         {
-            auto offset = frame_info.camera_ptr->get_position() - go->transform.translation;
+            auto offset = frame_info.camera_ptr->get_position() - transforms.get(entities[i]).translation();
             float dis_squared = glm::dot(offset, offset);
-            sorted[dis_squared] = go->id();
+            sorted.emplace_back(dis_squared, i);
         }
+        std::ranges::sort(sorted, std::greater{}, &std::pair<float, uint32_t>::first);
         
         pipeline_->bind(frame_info.command_buffer);
 
@@ -81,24 +96,18 @@ void point_light_system::render()
             0,
             1,
             &frame_info.global_descriptor_set,
-            0,
-            nullptr
+            1,
+            &frame_info.global_ubo_offset
         );
 
-        std::map<game_object::id_t, game_object*> game_objects;
-        for (auto &go : frame_info.game_objects)
-        {
-            game_objects[go->id()] = go;
-        }
-        
-        for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+        for (auto const &[dis_squared, index] : sorted)
         {
-            auto &go = game_objects.at(it->second);
+            transform_component const &transform = transforms.get(entities[index]);
 
             point_light_push_constants push{};
-            push.position = glm::vec4{go->transform.translation, 1.0f};
-            push.color    = glm::vec4{go->color, go->point_light->light_intensity};
-            push.radius   = go->transform.scale.x;
+            push.position = glm::vec4{transform.translation(), 1.0f};
+            push.color    = glm::vec4{lights[index].color, lights[index].light_intensity};
+            push.radius   = transform.scale().x;
 
             vkCmdPushConstants(
                 frame_info.command_buffer,
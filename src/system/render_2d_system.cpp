@@ -40,15 +40,25 @@ namespace dae
             0,
             1,
             &frame_info.global_descriptor_set,
-            0,
-            nullptr
+            1,
+            &frame_info.global_ubo_offset
         );
-        
-        for (auto const &obj : frame_info.game_objects)
+
+        model const *bound_model = nullptr;
+        auto &transforms = frame_info.components->transforms();
+        auto const meshes   = frame_info.components->meshes().components();
+        auto const entities = frame_info.components->meshes().entities();
+
+        // Only what intersects the frustum is recorded
+        auto const visible = frustum_culler::cull(*frame_info.camera_ptr, *frame_info.components, culling_statistics_);
+        for (uint32_t const i : visible)
         {
+            model &mesh = *meshes[i].model;
+            transform_component const &transform = transforms.get(entities[i]);
+
             push_constant_data_2d push{};
-            push.transform = obj->transform.mat4();
-            push.use_texture = obj->use_texture;
+            push.transform = transform.mat4();
+            push.use_texture = meshes[i].use_texture;
 
             vkCmdPushConstants(
                 frame_info.command_buffer,
@@ -58,8 +68,12 @@ namespace dae
                 sizeof(push_constant_data_2d),
                 &push);
             
-            obj->model->bind(frame_info.command_buffer);
-            obj->model->draw(frame_info.command_buffer);
+            if (bound_model == nullptr or not mesh.shares_bindings(*bound_model))
+            {
+                mesh.bind(frame_info.command_buffer);
+                bound_model = &mesh;
+            }
+            mesh.draw(frame_info.command_buffer);
         }
     }
 
@@ -3,6 +3,7 @@
 // Project includes
 #include "src/engine/frame_info.h"
 #include "src/vulkan/device.h"
+#include "src/vulkan/frame_allocator.h"
 #include "src/vulkan/renderer.h"
 
 // Standard includes
@@ -11,10 +12,16 @@
 
 namespace dae
 {
-    struct texture_pbr_push_constant
+    // Set 1 of the texture_pbr vertex shaders, written to the frame allocator per object
+    struct texture_pbr_object_data
     {
         glm::mat4 model_matrix{1.0f};
         glm::mat4 normal_matrix{1.0f};
+    };
+    static_assert(sizeof(texture_pbr_object_data) <= frame_allocator::object_range);
+
+    struct texture_pbr_push_constant
+    {
         int shading_mode;
         bool use_normal;
     };
@@ -28,7 +35,13 @@ namespace dae
     void texture_pbr_system::render()
     {
         auto &frame_info = frame_info::instance();
+        auto &frame_allocator = frame_allocator::instance();
         pipeline_->bind(frame_info.command_buffer);
+        auto         bound_layout = model::vertex_layout::full;
+        model const *bound_model  = nullptr;
+
+        // The pipelines draw both faces, so meshlets are only culled against the frustum
+        meshlet_culler culler{*frame_info.camera_ptr, false};
 
         vkCmdBindDescriptorSets(
             frame_info.command_buffer,
@@ -37,39 +50,76 @@ namespace dae
             0,
             1,
             &frame_info.global_descriptor_set,
-            0,
-            nullptr
+            1,
+            &frame_info.global_ubo_offset
         );
 
-        for (auto const &obj : frame_info.game_objects)
+        // Shading settings are the same for every object, pushed once
+        texture_pbr_push_constant push{};
+        push.use_normal = frame_info.use_normal;
+        push.shading_mode = frame_info.shading_mode;
+
+        vkCmdPushConstants(
+            frame_info.command_buffer,
+            pipeline_layout_,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            0,
+            sizeof(texture_pbr_push_constant),
+            &push);
+
+        auto &transforms = frame_info.components->transforms();
+        auto const meshes   = frame_info.components->meshes().components();
+        auto const entities = frame_info.components->meshes().entities();
+
+        // Only what intersects the frustum is recorded
+        auto const visible = frustum_culler::cull(*frame_info.camera_ptr, *frame_info.components, culling_statistics_);
+        for (uint32_t const i : visible)
         {
-            texture_pbr_push_constant push{};
-            push.model_matrix = obj->transform.mat4();
-            push.normal_matrix = obj->transform.normal_matrix();
-            push.use_normal = frame_info.use_normal;
-            push.shading_mode = frame_info.shading_mode;
+            model &mesh = *meshes[i].model;
+            transform_component const &transform = transforms.get(entities[i]);
 
-            vkCmdPushConstants(
+            if (mesh.layout() != bound_layout)
+            {
+                bound_layout = mesh.layout();
+                pipeline_for(bound_layout).bind(frame_info.command_buffer);
+            }
+
+            glm::mat4 const &model_matrix = transform.mat4();
+            texture_pbr_object_data object{};
+            object.model_matrix = model_matrix * mesh.dequantization_matrix();
+            object.normal_matrix = transform.normal_matrix();
+
+            frame_allocator::allocation const slot = frame_allocator.push_object(object);
+            vkCmdBindDescriptorSets(
                 frame_info.command_buffer,
+                VK_PIPELINE_BIND_POINT_GRAPHICS,
                 pipeline_layout_,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(texture_pbr_push_constant),
-                &push);
+                1,
+                1,
+                &slot.object_set,
+                1,
+                &slot.offset);
             
-            obj->model->bind(frame_info.command_buffer);
-            obj->model->draw(frame_info.command_buffer);
+            // Models suballocated from the same arena pools share their vertex and index buffers
+            if (bound_model == nullptr or not mesh.shares_bindings(*bound_model))
+            {
+                mesh.bind(frame_info.command_buffer);
+                bound_model = &mesh;
+            }
+            mesh.draw(frame_info.command_buffer, model_matrix, culler);
         }
+
+        meshlet_statistics_ = culler.stats();
     }
 
     void texture_pbr_system::create_pipeline_layout(VkDescriptorSetLayout global_set_layout)
     {
         VkPushConstantRange push_constant_range{};
-        push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        push_constant_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
         push_constant_range.offset     = 0;
         push_constant_range.size       = sizeof(texture_pbr_push_constant);
         
-        std::vector<VkDescriptorSetLayout> descriptor_set_layouts{global_set_layout};
+        std::vector<VkDescriptorSetLayout> descriptor_set_layouts{global_set_layout, frame_allocator::instance().object_set_layout()};
         
         VkPipelineLayoutCreateInfo pipeline_layout_info{};
         pipeline_layout_info.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -96,5 +146,11 @@ namespace dae
             "shaders/texture_pbr.vert.spv",
             "shaders/texture_pbr.frag.spv",
             pipeline_config);
+
+        set_packed_shaders(
+            render_pass,
+            "shaders/texture_pbr_packed.vert.spv",
+            "shaders/texture_pbr_packed.vert.spv",
+            "shaders/texture_pbr.frag.spv");
     }
 }
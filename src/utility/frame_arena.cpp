@@ -0,0 +1,76 @@
+﻿#include "frame_arena.h"
+
+// Standard includes
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <new>
+
+namespace dae
+{
+    frame_arena::frame_arena()
+        : buffer_{std::make_unique<std::byte[]>(initial_capacity)}
+    {
+        stats_.capacity = initial_capacity;
+        spills_.reserve(16);
+    }
+
+    frame_arena::~frame_arena()
+    {
+        release_spills();
+    }
+
+    void frame_arena::reset()
+    {
+        // Whatever spilled this frame fits in the buffer from now on
+        if (not spills_.empty())
+        {
+            release_spills();
+            stats_.capacity = std::bit_ceil(stats_.used_bytes);
+            buffer_         = std::make_unique<std::byte[]>(stats_.capacity);
+        }
+
+        head_             = 0;
+        stats_.used_bytes = 0;
+    }
+
+    void frame_arena::release_spills()
+    {
+        for (auto const &spilled : spills_)
+        {
+            ::operator delete(spilled.data, spilled.size, std::align_val_t{spilled.alignment});
+        }
+        spills_.clear();
+    }
+
+    auto frame_arena::do_allocate(size_t bytes, size_t alignment) -> void *
+    {
+        // Aligned relative to the buffer's address, make_unique only guarantees the default new alignment
+        auto const base    = reinterpret_cast<uintptr_t>(buffer_.get());
+        size_t const offset = ((base + head_ + alignment - 1) & ~(alignment - 1)) - base;
+
+        stats_.used_bytes += offset - head_ + bytes;
+        stats_.peak_bytes  = std::max(stats_.peak_bytes, stats_.used_bytes);
+
+        if (offset + bytes <= stats_.capacity)
+        {
+            head_ = offset + bytes;
+            return buffer_.get() + offset;
+        }
+
+        ++stats_.spills;
+        void *data = ::operator new(bytes, std::align_val_t{alignment});
+        spills_.push_back({data, bytes, alignment});
+        return data;
+    }
+
+    void frame_arena::do_deallocate(void *, size_t, size_t)
+    {
+        // Released all at once in reset
+    }
+
+    auto frame_arena::do_is_equal(std::pmr::memory_resource const &other) const noexcept -> bool
+    {
+        return this == &other;
+    }
+}
@@ -0,0 +1,74 @@
+﻿#pragma once
+
+// Project includes
+#include "src/utility/singleton.h"
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace dae
+{
+    // Scratch memory for the CPU side of one frame. Allocations bump a pointer through one buffer and are never freed
+    // individually, reset releases all of them at the start of the next frame. A frame that does not fit spills to the
+    // heap and the buffer grows on the following reset, so the steady state frame loop never touches the heap.
+    // Containers opt in through std::pmr, nothing allocated here may outlive the frame. Only used by the main thread.
+    class frame_arena final : public singleton<frame_arena>, public std::pmr::memory_resource
+    {
+    public:
+        struct statistics
+        {
+            size_t   capacity   = 0;
+            size_t   used_bytes = 0; // in the current frame, spilled bytes included
+            size_t   peak_bytes = 0; // over every frame so far
+            uint64_t spills     = 0; // heap allocations over every frame so far
+        };
+
+        ~frame_arena() override;
+
+        frame_arena(frame_arena const &)            = delete;
+        frame_arena(frame_arena &&)                 = delete;
+        frame_arena &operator=(frame_arena const &) = delete;
+        frame_arena &operator=(frame_arena &&)      = delete;
+
+        // Everything allocated during the previous frame is gone, destructors are not run
+        void reset();
+
+        template <typename T>
+        auto make_vector(size_t capacity = 0) -> std::pmr::vector<T>
+        {
+            std::pmr::vector<T> result{this};
+            result.reserve(capacity);
+            return result;
+        }
+
+        [[nodiscard]] auto stats() const -> statistics { return stats_; }
+
+        static constexpr size_t initial_capacity = 256ull << 10;
+
+    private:
+        friend class singleton<frame_arena>;
+        frame_arena();
+
+        struct spill
+        {
+            void  *data      = nullptr;
+            size_t size      = 0;
+            size_t alignment = 0;
+        };
+
+        void release_spills();
+
+        auto do_allocate(size_t bytes, size_t alignment) -> void * override;
+        void do_deallocate(void *data, size_t bytes, size_t alignment) override;
+        [[nodiscard]] auto do_is_equal(std::pmr::memory_resource const &other) const noexcept -> bool override;
+
+        std::unique_ptr<std::byte[]> buffer_ = {};
+        size_t                       head_   = 0;
+        std::vector<spill>           spills_ = {};
+        statistics                   stats_  = {};
+    };
+}
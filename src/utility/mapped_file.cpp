@@ -0,0 +1,130 @@
+﻿#include "mapped_file.h"
+
+// Standard includes
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dae
+{
+    // A file that can't be opened or mapped leaves the object closed, callers check is_open()
+    mapped_file::mapped_file(std::string const &file_path)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        LARGE_INTEGER file_size{};
+        if (not GetFileSizeEx(file, &file_size) or file_size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            CloseHandle(file);
+            return;
+        }
+
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return;
+        }
+
+        file_handle_    = file;
+        mapping_handle_ = mapping;
+        data_           = static_cast<std::byte const *>(view);
+        size_           = static_cast<size_t>(file_size.QuadPart);
+#else
+        int const file = ::open(file_path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return;
+        }
+
+        struct stat file_stat{};
+        if (::fstat(file, &file_stat) != 0 or file_stat.st_size == 0)
+        {
+            ::close(file);
+            return;
+        }
+
+        void *view = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file); // the mapping keeps its own reference to the file
+
+        if (view == MAP_FAILED)
+        {
+            return;
+        }
+
+        data_ = static_cast<std::byte const *>(view);
+        size_ = static_cast<size_t>(file_stat.st_size);
+#endif
+    }
+
+    mapped_file::~mapped_file()
+    {
+        close();
+    }
+
+    mapped_file::mapped_file(mapped_file &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    mapped_file &mapped_file::operator=(mapped_file &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+#if defined(_WIN32)
+            file_handle_    = std::exchange(other.file_handle_, nullptr);
+            mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    void mapped_file::close()
+    {
+        if (data_ == nullptr)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_handle_);
+        CloseHandle(file_handle_);
+        file_handle_    = nullptr;
+        mapping_handle_ = nullptr;
+#else
+        ::munmap(const_cast<std::byte *>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,39 @@
+﻿#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace dae
+{
+    // Read-only memory mapping of a whole file, unmapped on destruction
+    class mapped_file final
+    {
+    public:
+        mapped_file() = default;
+        explicit mapped_file(std::string const &file_path);
+        ~mapped_file();
+
+        mapped_file(mapped_file const &)            = delete;
+        mapped_file &operator=(mapped_file const &) = delete;
+        mapped_file(mapped_file &&other) noexcept;
+        mapped_file &operator=(mapped_file &&other) noexcept;
+
+        [[nodiscard]] auto is_open() const -> bool { return data_ != nullptr; }
+        [[nodiscard]] auto data() const -> std::byte const * { return data_; }
+        [[nodiscard]] auto size() const -> size_t { return size_; }
+        [[nodiscard]] auto bytes() const -> std::span<std::byte const> { return {data_, size_}; }
+
+    private:
+        void close();
+
+        std::byte const *data_ = nullptr;
+        size_t           size_ = 0;
+
+#if defined(_WIN32)
+        void *file_handle_    = nullptr;
+        void *mapping_handle_ = nullptr;
+#endif
+    };
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+
+// Standard includes
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+    // Number of ranges parallel_for splits [0, count) into, at most one per hardware thread
+    inline auto parallel_range_count(size_t count, size_t min_range_size) -> size_t
+    {
+        size_t const thread_count = std::max(1u, std::thread::hardware_concurrency());
+        return std::clamp<size_t>(count / std::max<size_t>(1, min_range_size), 1, thread_count);
+    }
+
+    // Runs task(range_index, begin, end) over contiguous ranges of [0, count), the calling thread takes range 0.
+    // The first exception thrown by any range is rethrown once all ranges finished.
+    template <typename task_t>
+    void parallel_for(size_t count, size_t min_range_size, task_t const &task)
+    {
+        size_t const range_count = parallel_range_count(count, min_range_size);
+        if (range_count == 1)
+        {
+            task(size_t{0}, size_t{0}, count);
+            return;
+        }
+
+        std::vector<std::exception_ptr> errors(range_count);
+        std::vector<std::thread>        workers{};
+        workers.reserve(range_count - 1);
+
+        auto const run_range = [&](size_t range)
+        {
+            try { task(range, count * range / range_count, count * (range + 1) / range_count); }
+            catch (...) { errors[range] = std::current_exception(); }
+        };
+
+        for (size_t range = 1; range < range_count; ++range)
+        {
+            workers.emplace_back(run_range, range);
+        }
+        run_range(0);
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        for (auto const &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+}
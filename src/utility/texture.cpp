@@ -4,9 +4,12 @@
 #include "src/engine/engine.h"
 #include "src/vulkan/buffer.h"
 #include "src/vulkan/device.h"
+#include "src/vulkan/upload_batch.h"
 
 // Standard includes
 #include <cmath>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 
 // STB includes
@@ -25,24 +28,35 @@
 
 namespace dae
 {
-    texture::texture(std::string const & file_path, VkFormat format)
-        : device_ptr_{&device::instance()}
-        , image_format_{format}
+    auto texture::load_image(std::string const &file_path) -> image_data
     {
         int text_channels;
+        image_data image{};
 
         std::string const path = ENGINE_DIR + engine::data_path + file_path;
-        stbi_uc *pixels = stbi_load(path.c_str(), &width_, &height_, &text_channels, STBI_rgb_alpha);
-        mip_levels_ = static_cast<uint32_t>(std::floor(std::log2(std::max(width_, height_)))) + 1;
+        stbi_uc *pixels = stbi_load(path.c_str(), &image.width, &image.height, &text_channels, STBI_rgb_alpha);
+        if (not pixels)
+        {
+            throw std::runtime_error{"Failed to load texture " + file_path};
+        }
+
+        image.pixels.assign(pixels, pixels + static_cast<size_t>(image.width) * image.height * 4);
+        stbi_image_free(pixels);
+        return image;
+    }
 
-        buffer staging_buffer{
-            4,
-            static_cast<uint32_t>(width_ * height_),
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+    texture::texture(std::string const & file_path, VkFormat format)
+        : texture{load_image(file_path), format}
+    {
+    }
 
-        staging_buffer.map();
-        staging_buffer.write_to_buffer(pixels);
+    texture::texture(image_data const &image, VkFormat format)
+        : device_ptr_{&device::instance()}
+        , image_format_{format}
+        , width_{image.width}
+        , height_{image.height}
+    {
+        mip_levels_ = static_cast<uint32_t>(std::floor(std::log2(std::max(width_, height_)))) + 1;
 
         VkImageCreateInfo image_info{};
         image_info.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -59,10 +73,23 @@ namespace dae
         image_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
         image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-        device_ptr_->create_image_with_info(image_info,VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image_, image_memory_);
+        device_ptr_->create_image_with_info(image_info,VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image_, image_allocation_);
         transition_image_layout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        device_ptr_->copy_buffer_to_image(staging_buffer.get_buffer(), image_, static_cast<uint32_t>(width_), static_cast<uint32_t>(height_), 1);
+
+        // Staged right before the copy, single time commands in between would hand the space back early
+        auto staging = device_ptr_->staging().allocate(image.pixels.size());
+        std::memcpy(staging.mapped, image.pixels.data(), image.pixels.size());
+
+        device_ptr_->copy_buffer_to_image(staging.buffer, image_, static_cast<uint32_t>(width_), static_cast<uint32_t>(height_), 1, staging.offset);
+        if (auto *batch = upload_batch::active())
+        {
+            batch->release_image(image_, {VK_IMAGE_ASPECT_COLOR_BIT, 0, mip_levels_, 0, 1}, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        }
         generate_mipmaps();
+        if (staging.dedicated)
+        {
+            upload_batch::retire(std::move(staging.dedicated)); // still read by the active batch's copy
+        }
 
         image_layout_ = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
@@ -104,14 +131,12 @@ namespace dae
         view_info.components.a                    = VK_COMPONENT_SWIZZLE_A;
 
         vkCreateImageView(device_ptr_->logical_device(), &view_info, nullptr, &image_view_);
-
-        stbi_image_free(pixels);
     }
 
     texture::~texture()
     {
         vkDestroyImage(device_ptr_->logical_device(), image_, nullptr);
-        vkFreeMemory(device_ptr_->logical_device(), image_memory_, nullptr);
+        device_ptr_->memory().free(image_allocation_);
         vkDestroyImageView(device_ptr_->logical_device(), image_view_, nullptr);
         vkDestroySampler(device_ptr_->logical_device(), sampler_, nullptr);
     }
@@ -182,7 +207,9 @@ namespace dae
             throw std::runtime_error("texture image format does not support linear blitting!");
         }
 
-        VkCommandBuffer command_buffer = device_ptr_->begin_single_time_commands();
+        // Blits need the graphics queue, inside an upload batch they run after its copies
+        auto *const     batch          = upload_batch::active();
+        VkCommandBuffer command_buffer = batch ? batch->graphics_command_buffer() : device_ptr_->begin_single_time_commands();
 
         VkImageMemoryBarrier barrier{};
         barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -280,6 +307,9 @@ namespace dae
             1,
             &barrier);
 
-        device_ptr_->end_single_time_commands(command_buffer);
+        if (batch == nullptr)
+        {
+            device_ptr_->end_single_time_commands(command_buffer);
+        }
     }
 }
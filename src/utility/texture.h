@@ -1,7 +1,11 @@
 ﻿#pragma once
 
+// Project includes
+#include "src/vulkan/memory_allocator.h"
+
 // Standard includes
 #include <string>
+#include <vector>
 
 // Vulkan includes
 #include <vulkan/vulkan.h>
@@ -14,7 +18,18 @@ namespace dae
     class texture
     {
     public:
+        // RGBA8 pixels decoded from disk, independent of the device so it can be produced on any thread
+        struct image_data
+        {
+            std::vector<unsigned char> pixels = {};
+            int width  = 0;
+            int height = 0;
+        };
+
+        static auto load_image(std::string const &file_path) -> image_data;
+
         texture(std::string const & file_path, VkFormat format);
+        texture(image_data const &image, VkFormat format);
         ~texture();
 
         texture(texture const &)            = delete;
@@ -31,13 +46,13 @@ namespace dae
         void generate_mipmaps();
 
     private:
-        device         *device_ptr_;
-        VkImage        image_        = VK_NULL_HANDLE;
-        VkDeviceMemory image_memory_ = VK_NULL_HANDLE;
-        VkImageView    image_view_   = VK_NULL_HANDLE;
-        VkSampler      sampler_      = VK_NULL_HANDLE;
-        VkFormat       image_format_ = VK_FORMAT_UNDEFINED;
-        VkImageLayout  image_layout_ = VK_IMAGE_LAYOUT_UNDEFINED;
+        device                       *device_ptr_;
+        VkImage                      image_            = VK_NULL_HANDLE;
+        memory_allocator::allocation image_allocation_ = {};
+        VkImageView                  image_view_       = VK_NULL_HANDLE;
+        VkSampler                    sampler_          = VK_NULL_HANDLE;
+        VkFormat                     image_format_     = VK_FORMAT_UNDEFINED;
+        VkImageLayout                image_layout_     = VK_IMAGE_LAYOUT_UNDEFINED;
 
         int      width_      = 0;
         int      height_     = 0;
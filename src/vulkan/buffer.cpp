@@ -10,6 +10,7 @@
 #include "src/vulkan/device.h"
 
 // Standard includes
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -38,7 +39,8 @@ namespace dae
         uint32_t              instance_count,
         VkBufferUsageFlags    usage_flags,
         VkMemoryPropertyFlags memory_property_flags,
-        VkDeviceSize          min_offset_alignment)
+        VkDeviceSize          min_offset_alignment,
+        bool                  shared_with_transfer_queue)
         : device_ptr_{&device::instance()},
           instance_count_{instance_count},
           instance_size_{instance_size},
@@ -47,19 +49,21 @@ namespace dae
     {
         alignment_size_ = get_alignment(instance_size, min_offset_alignment);
         buffer_size_ = alignment_size_ * instance_count;
-        device_ptr_->create_buffer(buffer_size_, usage_flags, memory_property_flags, buffer_, memory_);
+        device_ptr_->create_buffer(buffer_size_, usage_flags, memory_property_flags, buffer_, allocation_, shared_with_transfer_queue);
     }
 
     buffer::~buffer()
     {
         unmap();
         vkDestroyBuffer(device_ptr_->logical_device(), buffer_, nullptr);
-        vkFreeMemory(device_ptr_->logical_device(), memory_, nullptr);
+        device_ptr_->memory().free(allocation_);
     }
 
     /**
      * Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
      *
+     * @note Host visible memory stays mapped by the allocator, this only hands out the pointer
+     *
      * @param size (Optional) Size of the memory range to map. Pass VK_WHOLE_SIZE to map the complete
      * buffer range.
      * @param offset (Optional) Byte offset from beginning
@@ -68,22 +72,23 @@ namespace dae
      */
     auto buffer::map(VkDeviceSize size, VkDeviceSize offset) -> VkResult
     {
-        assert(buffer_ and memory_ and "Called map on buffer before create");
-        return vkMapMemory(device_ptr_->logical_device(), memory_, offset, size, 0, &mapped_);
+        assert(buffer_ and allocation_.valid() and "Called map on buffer before create");
+        if (not allocation_.mapped)
+        {
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+        mapped_ = static_cast<char*>(allocation_.mapped) + offset;
+        return VK_SUCCESS;
     }
 
     /**
      * Unmap a mapped memory range
      *
-     * @note Does not return a result as vkUnmapMemory can't fail
+     * @note The memory itself stays mapped until the allocator frees its block
      */
     void buffer::unmap()
     {
-        if (mapped_)
-        {
-            vkUnmapMemory(device_ptr_->logical_device(), memory_);
-            mapped_ = nullptr;
-        }
+        mapped_ = nullptr;
     }
 
     /**
@@ -124,11 +129,7 @@ namespace dae
      */
     auto buffer::flush(VkDeviceSize size, VkDeviceSize offset) -> VkResult
     {
-        VkMappedMemoryRange mapped_range = {};
-        mapped_range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mapped_range.memory = memory_;
-        mapped_range.offset = offset;
-        mapped_range.size   = size;
+        VkMappedMemoryRange const mapped_range = memory_range(size, offset);
         return vkFlushMappedMemoryRanges(device_ptr_->logical_device(), 1, &mapped_range);
     }
 
@@ -145,12 +146,32 @@ namespace dae
      */
     auto buffer::invalidate(VkDeviceSize size, VkDeviceSize offset) -> VkResult
     {
+        VkMappedMemoryRange const mapped_range = memory_range(size, offset);
+        return vkInvalidateMappedMemoryRanges(device_ptr_->logical_device(), 1, &mapped_range);
+    }
+
+    /**
+     * Translates a range of the buffer to the memory it shares with other allocations
+     *
+     * @note Widened to whole nonCoherentAtomSize units, the allocator aligns non-coherent allocations to them
+     *
+     * @param size Size of the range, VK_WHOLE_SIZE for the rest of the buffer
+     * @param offset Byte offset from beginning
+     *
+     * @return VkMappedMemoryRange within the allocation
+     */
+    auto buffer::memory_range(VkDeviceSize size, VkDeviceSize offset) const -> VkMappedMemoryRange
+    {
+        VkDeviceSize const atom  = std::max<VkDeviceSize>(1, device_ptr_->properties.limits.nonCoherentAtomSize);
+        VkDeviceSize const end   = size == VK_WHOLE_SIZE ? allocation_.size : std::min(allocation_.size, (offset + size + atom - 1) / atom * atom);
+        VkDeviceSize const begin = offset / atom * atom;
+
         VkMappedMemoryRange mapped_range = {};
         mapped_range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mapped_range.memory = memory_;
-        mapped_range.offset = offset;
-        mapped_range.size   = size;
-        return vkInvalidateMappedMemoryRanges(device_ptr_->logical_device(), 1, &mapped_range);
+        mapped_range.memory = allocation_.memory;
+        mapped_range.offset = allocation_.offset + begin;
+        mapped_range.size   = end - begin;
+        return mapped_range;
     }
 
     /**
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+// Project includes
+#include "src/vulkan/memory_allocator.h"
+
 // Vulkan includes
 #include <vulkan/vulkan.h>
 
@@ -16,7 +19,8 @@ namespace dae
             uint32_t instance_count,
             VkBufferUsageFlags usage_flags,
             VkMemoryPropertyFlags memory_property_flags,
-            VkDeviceSize min_offset_alignment = 1);
+            VkDeviceSize min_offset_alignment = 1,
+            bool shared_with_transfer_queue = false);
         ~buffer();
 
         buffer(buffer const & other)            = delete;
@@ -47,11 +51,12 @@ namespace dae
 
     private:
         static auto get_alignment(VkDeviceSize instance_size, VkDeviceSize min_offset_alignment) -> VkDeviceSize;
+        auto memory_range(VkDeviceSize size, VkDeviceSize offset) const -> VkMappedMemoryRange;
 
-        device         *device_ptr_ = nullptr;
-        void           *mapped_      = nullptr;
-        VkBuffer       buffer_       = VK_NULL_HANDLE;
-        VkDeviceMemory memory_       = VK_NULL_HANDLE;
+        device                       *device_ptr_ = nullptr;
+        void                         *mapped_     = nullptr;
+        VkBuffer                     buffer_      = VK_NULL_HANDLE;
+        memory_allocator::allocation allocation_  = {};
 
         VkDeviceSize          buffer_size_           = 0;
         uint32_t              instance_count_        = 0;
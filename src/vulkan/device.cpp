@@ -3,8 +3,11 @@
 // Project includes
 #include "src/engine/window.h"
 #include "src/utility/utils.h"
+#include "src/vulkan/upload_batch.h"
 
 // Standard includes
+#include <algorithm>
+#include <cassert>
 #include <cstring>
 #include <iostream>
 #include <set>
@@ -12,6 +15,37 @@
 
 namespace dae
 {
+    // Resources are accounted by what they are created for
+    static auto buffer_category(VkBufferUsageFlags usage) -> memory_category
+    {
+        if (usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+        {
+            return memory_category::mesh;
+        }
+        if (usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+        {
+            return memory_category::uniform;
+        }
+        if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+        {
+            return memory_category::staging;
+        }
+        return memory_category::other;
+    }
+
+    static auto image_category(VkImageUsageFlags usage) -> memory_category
+    {
+        if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+        {
+            return memory_category::depth;
+        }
+        if (usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+        {
+            return memory_category::texture;
+        }
+        return memory_category::other;
+    }
+
     // local callback functions
     static auto VKAPI_CALL debug_callback(
         VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
@@ -55,6 +89,9 @@ namespace dae
 
     device::~device()
     {
+        staging_ring_.reset();
+        memory_budget_.reset();
+        memory_allocator_.reset();
         vkDestroyCommandPool(device_, command_pool_, nullptr);
         vkDestroyDevice(device_, nullptr);
 
@@ -76,6 +113,13 @@ namespace dae
         pick_physical_device();
         create_logical_device();
         create_command_pool();
+
+        memory_allocator_ = std::make_unique<memory_allocator>(device_, physical_device_);
+
+        auto const get_memory_properties_2 = memory_budget_enabled_
+            ? reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(vkGetInstanceProcAddr(instance_, "vkGetPhysicalDeviceMemoryProperties2KHR"))
+            : nullptr;
+        memory_budget_ = std::make_unique<memory_budget>(physical_device_, get_memory_properties_2, *memory_allocator_);
     }
 
     void device::create_instance()
@@ -98,6 +142,13 @@ namespace dae
         create_info.pApplicationInfo = &app_info;
 
         auto extensions = required_extensions();
+
+        // Needed to query VK_EXT_memory_budget on a 1.0 instance
+        properties_2_enabled_ = is_instance_extension_available(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        if (properties_2_enabled_)
+        {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
         create_info.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
         create_info.ppEnabledExtensionNames = extensions.data();
 
@@ -160,7 +211,10 @@ namespace dae
         queue_family_indices indices = find_queue_families(physical_device_);
 
         std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
-        std::set<uint32_t> unique_queue_families = {indices.graphics_family, indices.present_family};
+        graphics_family_ = indices.graphics_family;
+        transfer_family_ = indices.transfer_family_has_value ? indices.transfer_family : indices.graphics_family;
+
+        std::set<uint32_t> unique_queue_families = {indices.graphics_family, indices.present_family, transfer_family_};
 
         float queuePriority = 1.0f;
         for (uint32_t queue_family : unique_queue_families)
@@ -182,9 +236,16 @@ namespace dae
         create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
         create_info.pQueueCreateInfos    = queue_create_infos.data();
 
+        std::vector<const char*> extensions = device_extensions_;
+        memory_budget_enabled_ = properties_2_enabled_ and is_device_extension_available(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (memory_budget_enabled_)
+        {
+            extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
         create_info.pEnabledFeatures        = &device_features;
-        create_info.enabledExtensionCount   = static_cast<uint32_t>(device_extensions_.size());
-        create_info.ppEnabledExtensionNames = device_extensions_.data();
+        create_info.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
+        create_info.ppEnabledExtensionNames = extensions.data();
 
         if (enable_validation_layers)
         {
@@ -203,6 +264,12 @@ namespace dae
 
         vkGetDeviceQueue(device_, indices.graphics_family, 0, &graphics_queue_);
         vkGetDeviceQueue(device_, indices.present_family, 0, &present_queue_);
+        vkGetDeviceQueue(device_, transfer_family_, 0, &transfer_queue_);
+
+#ifndef NDEBUG
+        std::cout << YELLOW_TEXT("[Device]\n") << ONE_TAB
+                  << (has_transfer_queue() ? "uploads on transfer family " + std::to_string(transfer_family_) : std::string{"uploads on the graphics queue"}) << '\n';
+#endif
     }
 
     void device::create_command_pool()
@@ -359,6 +426,26 @@ namespace dae
         return required_extensions.empty();
     }
 
+    auto device::is_instance_extension_available(char const *extension_name) -> bool
+    {
+        uint32_t extension_count = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, nullptr);
+        std::vector<VkExtensionProperties> extensions(extension_count);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, extensions.data());
+
+        return std::any_of(extensions.begin(), extensions.end(), [&](auto const &extension) { return strcmp(extension.extensionName, extension_name) == 0; });
+    }
+
+    auto device::is_device_extension_available(char const *extension_name) -> bool
+    {
+        uint32_t extension_count = 0;
+        vkEnumerateDeviceExtensionProperties(physical_device_, nullptr, &extension_count, nullptr);
+        std::vector<VkExtensionProperties> extensions(extension_count);
+        vkEnumerateDeviceExtensionProperties(physical_device_, nullptr, &extension_count, extensions.data());
+
+        return std::any_of(extensions.begin(), extensions.end(), [&](auto const &extension) { return strcmp(extension.extensionName, extension_name) == 0; });
+    }
+
     auto device::find_queue_families(VkPhysicalDevice device) -> queue_family_indices
     {
         queue_family_indices indices;
@@ -369,24 +456,37 @@ namespace dae
         std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
 
+        // A transfer only family is usually backed by DMA engines, a compute family without graphics is the next best
+        bool transfer_family_is_dedicated = false;
+
         int i = 0;
         for (const auto &queue_family : queue_families)
         {
-            if (queue_family.queueCount > 0 and queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            // Graphics and present keep the families found up to the first one completing the pair
+            if (not indices.is_complete())
             {
-                indices.graphics_family = i;
-                indices.graphics_family_has_value = true;
-            }
-            VkBool32 present_support = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &present_support);
-            if (queue_family.queueCount > 0 and present_support)
-            {
-                indices.present_family = i;
-                indices.present_family_has_value = true;
+                if (queue_family.queueCount > 0 and queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+                {
+                    indices.graphics_family = i;
+                    indices.graphics_family_has_value = true;
+                }
+                VkBool32 present_support = false;
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &present_support);
+                if (queue_family.queueCount > 0 and present_support)
+                {
+                    indices.present_family = i;
+                    indices.present_family_has_value = true;
+                }
             }
-            if (indices.is_complete())
+
+            bool const transfer_capable = queue_family.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT);
+            bool const dedicated        = not (queue_family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+            if (queue_family.queueCount > 0 and transfer_capable and not (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) and
+                (not indices.transfer_family_has_value or (dedicated and not transfer_family_is_dedicated)))
             {
-                break;
+                indices.transfer_family = i;
+                indices.transfer_family_has_value = true;
+                transfer_family_is_dedicated = dedicated;
             }
 
             i++;
@@ -458,12 +558,26 @@ namespace dae
         throw std::runtime_error("failed to find suitable memory type!");
     }
 
+    auto device::has_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) -> bool
+    {
+        VkPhysicalDeviceMemoryProperties const &mem_properties = memory_allocator_->memory_properties();
+        for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) and (mem_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void device::create_buffer(
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkMemoryPropertyFlags properties,
         VkBuffer &buffer,
-        VkDeviceMemory &buffer_memory)
+        memory_allocator::allocation &buffer_allocation,
+        bool shared_with_transfer_queue)
     {
         VkBufferCreateInfo buffer_info{};
         buffer_info.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -471,6 +585,15 @@ namespace dae
         buffer_info.usage       = usage;
         buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        // Written by both queues without ownership transfers, ordered by the upload semaphores and fences instead
+        uint32_t const queue_families[] = {graphics_family_, transfer_family_};
+        if (shared_with_transfer_queue and has_transfer_queue())
+        {
+            buffer_info.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+            buffer_info.queueFamilyIndexCount = 2;
+            buffer_info.pQueueFamilyIndices   = queue_families;
+        }
+
         if (vkCreateBuffer(device_, &buffer_info, nullptr, &buffer) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to create vertex buffer!");
@@ -479,21 +602,21 @@ namespace dae
         VkMemoryRequirements mem_requirements;
         vkGetBufferMemoryRequirements(device_, buffer, &mem_requirements);
 
-        VkMemoryAllocateInfo alloc_info{};
-        alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        alloc_info.allocationSize  = mem_requirements.size;
-        alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device_, &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS)
-        {
-            throw std::runtime_error("failed to allocate vertex buffer memory!");
-        }
+        buffer_allocation = memory_allocator_->allocate(
+            mem_requirements, find_memory_type(mem_requirements.memoryTypeBits, properties), memory_allocator::resource_kind::linear, buffer_category(usage));
 
-        vkBindBufferMemory(device_, buffer, buffer_memory, 0);
+        vkBindBufferMemory(device_, buffer, buffer_allocation.memory, buffer_allocation.offset);
     }
 
+    // Inside an upload_batch the commands are recorded into the batch and submitted with it
     auto device::begin_single_time_commands() -> VkCommandBuffer
     {
+        if (auto *batch = upload_batch::active())
+        {
+            batch->note_recorded();
+            return batch->command_buffer();
+        }
+
         VkCommandBufferAllocateInfo alloc_info{};
         alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -513,6 +636,11 @@ namespace dae
 
     void device::end_single_time_commands(VkCommandBuffer command_buffer)
     {
+        if (auto const *batch = upload_batch::active(); batch != nullptr and batch->command_buffer() == command_buffer)
+        {
+            return;
+        }
+
         vkEndCommandBuffer(command_buffer);
 
         VkSubmitInfo submit_info{};
@@ -523,6 +651,11 @@ namespace dae
         vkQueueSubmit(graphics_queue_, 1, &submit_info, VK_NULL_HANDLE);
         vkQueueWaitIdle(graphics_queue_);
 
+        if (staging_ring_)
+        {
+            staging_ring_->completed(nullptr);
+        }
+
         vkFreeCommandBuffers(device_, command_pool_, 1, &command_buffer);
     }
 
@@ -540,12 +673,12 @@ namespace dae
     }
 
     void device::copy_buffer_to_image(
-        VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layer_count)
+        VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layer_count, VkDeviceSize buffer_offset)
     {
         VkCommandBuffer command_buffer = begin_single_time_commands();
 
         VkBufferImageCopy region{};
-        region.bufferOffset      = 0;
+        region.bufferOffset      = buffer_offset;
         region.bufferRowLength   = 0;
         region.bufferImageHeight = 0;
 
@@ -567,11 +700,26 @@ namespace dae
         end_single_time_commands(command_buffer);
     }
 
+    auto device::staging() -> staging_ring &
+    {
+        if (not staging_ring_)
+        {
+            staging_ring_ = std::make_unique<staging_ring>(staging_capacity_);
+        }
+        return *staging_ring_;
+    }
+
+    void device::set_staging_capacity(VkDeviceSize capacity)
+    {
+        assert(not staging_ring_ and "The staging ring is sized before the first upload");
+        staging_capacity_ = capacity;
+    }
+
     void device::create_image_with_info(
         VkImageCreateInfo const &image_info,
         VkMemoryPropertyFlags properties,
         VkImage &image,
-        VkDeviceMemory &image_memory)
+        memory_allocator::allocation &image_allocation)
     {
         if (vkCreateImage(device_, &image_info, nullptr, &image) != VK_SUCCESS)
         {
@@ -581,17 +729,18 @@ namespace dae
         VkMemoryRequirements mem_requirements;
         vkGetImageMemoryRequirements(device_, image, &mem_requirements);
 
-        VkMemoryAllocateInfo alloc_info{};
-        alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        alloc_info.allocationSize  = mem_requirements.size;
-        alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device_, &alloc_info, nullptr, &image_memory) != VK_SUCCESS)
+        // Only tile based GPUs expose lazily allocated memory, everywhere else transient attachments get regular memory
+        if ((properties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) and not has_memory_type(mem_requirements.memoryTypeBits, properties))
         {
-            throw std::runtime_error("failed to allocate image memory!");
+            properties &= ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
         }
 
-        if (vkBindImageMemory(device_, image, image_memory, 0) != VK_SUCCESS)
+        auto const kind = image_info.tiling == VK_IMAGE_TILING_OPTIMAL ? memory_allocator::resource_kind::optimal
+                                                                       : memory_allocator::resource_kind::linear;
+        image_allocation = memory_allocator_->allocate(
+            mem_requirements, find_memory_type(mem_requirements.memoryTypeBits, properties), kind, image_category(image_info.usage));
+
+        if (vkBindImageMemory(device_, image, image_allocation.memory, image_allocation.offset) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to bind image memory!");
         }
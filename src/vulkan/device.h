@@ -2,8 +2,12 @@
 
 // Project includes
 #include "src/utility/singleton.h"
+#include "src/vulkan/memory_allocator.h"
+#include "src/vulkan/memory_budget.h"
+#include "src/vulkan/staging_ring.h"
 
 // std lib headers
+#include <memory>
 #include <vector>
 
 // vulkan headers
@@ -25,8 +29,10 @@ namespace dae
     {
         uint32_t graphics_family;
         uint32_t present_family;
+        uint32_t transfer_family;
         bool     graphics_family_has_value = false;
         bool     present_family_has_value  = false;
+        bool     transfer_family_has_value = false; // a family without graphics, preferably transfer only
         
         [[nodiscard]] auto is_complete() const -> bool { return graphics_family_has_value and present_family_has_value; }
     };
@@ -55,8 +61,15 @@ namespace dae
         [[nodiscard]] auto graphics_queue() const -> VkQueue { return graphics_queue_; }
         [[nodiscard]] auto present_queue() const -> VkQueue { return present_queue_; }
 
+        // The graphics queue and family when the device has no separate transfer family
+        [[nodiscard]] auto transfer_queue() const -> VkQueue { return transfer_queue_; }
+        [[nodiscard]] auto transfer_family() const -> uint32_t { return transfer_family_; }
+        [[nodiscard]] auto graphics_family() const -> uint32_t { return graphics_family_; }
+        [[nodiscard]] auto has_transfer_queue() const -> bool { return transfer_family_ != graphics_family_; }
+
         auto get_swap_chain_support() -> swap_chain_support_details { return query_swap_chain_support(physical_device_); }
         auto find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) -> uint32_t;
+        auto has_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) -> bool;
         auto find_physical_queue_families() -> queue_family_indices { return find_queue_families(physical_device_); }
         auto find_supported_format(std::vector<VkFormat> const &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) -> VkFormat;
 
@@ -66,17 +79,28 @@ namespace dae
             VkBufferUsageFlags usage,
             VkMemoryPropertyFlags properties,
             VkBuffer &buffer,
-            VkDeviceMemory &buffer_memory);
+            memory_allocator::allocation &buffer_allocation,
+            bool shared_with_transfer_queue = false);
         auto begin_single_time_commands() -> VkCommandBuffer;
         void end_single_time_commands(VkCommandBuffer command_buffer);
         void copy_buffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size);
-        void copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layer_count);
+        void copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layer_count, VkDeviceSize buffer_offset = 0);
+
+        // Every buffer and image is bound to a range handed out here, free it through the same allocator
+        [[nodiscard]] auto memory() -> memory_allocator & { return *memory_allocator_; }
+
+        // Usage per category and heap against the driver's budget, VK_EXT_memory_budget is enabled when supported
+        [[nodiscard]] auto budget() -> memory_budget & { return *memory_budget_; }
+
+        // Shared staging memory for every upload, created with the configured capacity on first use
+        [[nodiscard]] auto staging() -> staging_ring &;
+        void set_staging_capacity(VkDeviceSize capacity);
 
         void create_image_with_info(
             VkImageCreateInfo const &image_info,
             VkMemoryPropertyFlags properties,
             VkImage &image,
-            VkDeviceMemory &image_memory);
+            memory_allocator::allocation &image_allocation);
 
         VkPhysicalDeviceProperties properties;
 
@@ -100,6 +124,8 @@ namespace dae
         void populate_debug_messenger_create_info(VkDebugUtilsMessengerCreateInfoEXT &create_info);
         void has_gflw_required_instance_extensions();
         auto check_device_extension_support(VkPhysicalDevice device) -> bool;
+        auto is_instance_extension_available(char const *extension_name) -> bool;
+        auto is_device_extension_available(char const *extension_name) -> bool;
         auto query_swap_chain_support(VkPhysicalDevice device) -> swap_chain_support_details;
 
         VkInstance               instance_        = VK_NULL_HANDLE;
@@ -112,6 +138,20 @@ namespace dae
         VkSurfaceKHR surface_        = VK_NULL_HANDLE;
         VkQueue      graphics_queue_ = VK_NULL_HANDLE;
         VkQueue      present_queue_  = VK_NULL_HANDLE;
+        VkQueue      transfer_queue_ = VK_NULL_HANDLE;
+
+        uint32_t graphics_family_ = 0;
+        uint32_t transfer_family_ = 0;
+
+        std::unique_ptr<memory_allocator> memory_allocator_ = {};
+        std::unique_ptr<memory_budget>    memory_budget_    = {};
+
+        // Optional, the budget falls back to estimates without them
+        bool properties_2_enabled_  = false;
+        bool memory_budget_enabled_ = false;
+
+        std::unique_ptr<staging_ring> staging_ring_     = {};
+        VkDeviceSize                  staging_capacity_ = staging_ring::default_capacity;
 
         const std::vector<const char*> validation_layers_ = {"VK_LAYER_KHRONOS_validation"};
         const std::vector<const char*> device_extensions_ = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -0,0 +1,100 @@
+﻿#include "frame_allocator.h"
+
+// Project includes
+#include "src/vulkan/device.h"
+#include "src/vulkan/swap_chain.h"
+
+// Standard includes
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+namespace dae
+{
+    frame_allocator::frame_allocator()
+    {
+        auto const &limits = device::instance().properties.limits;
+        alignment_ = std::max({limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment, VkDeviceSize{16}});
+
+        object_set_layout_ = descriptor_set_layout::builder{}
+            .add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+            .build();
+
+        frames_.resize(swap_chain::MAX_FRAMES_IN_FLIGHT);
+        for (int i = 0; i < static_cast<int>(frames_.size()); ++i)
+        {
+            add_buffer(i);
+        }
+    }
+
+    void frame_allocator::begin_frame(int frame_index)
+    {
+        assert(frame_index >= 0 and frame_index < static_cast<int>(frames_.size()) and "Frame index out of range");
+        frame_index_       = frame_index;
+        head_              = 0;
+        buffer_index_      = 0;
+        stats_.allocations = 0;
+        stats_.used_bytes  = 0;
+    }
+
+    auto frame_allocator::allocate(VkDeviceSize size) -> allocation
+    {
+        assert(size <= buffer_capacity - object_range and "Allocation larger than a frame buffer");
+
+        // The object set reads object_range bytes at any offset handed out, so that much has to fit behind it
+        VkDeviceSize offset = (head_ + alignment_ - 1) / alignment_ * alignment_;
+        if (offset + std::max(size, object_range) > buffer_capacity)
+        {
+            // Recording is under way, so the frame moves on to its next buffer rather than failing
+            ++buffer_index_;
+            if (buffer_index_ == frames_[frame_index_].size())
+            {
+                add_buffer(frame_index_);
+            }
+            stats_.used_bytes += buffer_capacity - head_;
+            head_  = 0;
+            offset = 0;
+        }
+        stats_.used_bytes += offset - head_ + size;
+        head_ = offset + size;
+
+        ++stats_.allocations;
+        stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.used_bytes);
+
+        frame_buffer const &target = frames_[frame_index_][buffer_index_];
+        return {static_cast<std::byte *>(target.buffer->mapped_memory()) + offset, static_cast<uint32_t>(offset), target.object_set};
+    }
+
+    auto frame_allocator::descriptor_info(int frame_index, VkDeviceSize range) const -> VkDescriptorBufferInfo
+    {
+        return frames_[frame_index].front().buffer->descriptor_info(range, 0);
+    }
+
+    void frame_allocator::add_buffer(int frame_index)
+    {
+        frame_buffer added{};
+
+        // Coherent so the frame's writes need no flush before submission
+        added.buffer = std::make_unique<buffer>(
+            buffer_capacity,
+            1,
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        added.buffer->map();
+
+        // A pool per buffer, the chain grows at any time and a fixed pool would run out of sets
+        added.pool = descriptor_pool::builder{}
+            .set_max_sets(1)
+            .add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1)
+            .build();
+
+        auto object_info = added.buffer->descriptor_info(object_range, 0);
+        descriptor_writer{object_set_layout_.get(), added.pool.get()}
+            .write_buffer(0, &object_info)
+            .build(added.object_set);
+
+        frames_[frame_index].push_back(std::move(added));
+        stats_.capacity += buffer_capacity;
+        ++stats_.buffers;
+    }
+}
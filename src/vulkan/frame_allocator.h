@@ -0,0 +1,112 @@
+﻿#pragma once
+
+// Project includes
+#include "src/utility/singleton.h"
+#include "src/vulkan/buffer.h"
+#include "src/vulkan/descriptors.h"
+
+// Standard includes
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Vulkan includes
+#include <vulkan/vulkan.h>
+
+namespace dae
+{
+    // Per-frame uniform and storage data, bump allocated from persistently mapped buffers, one chain per frame in
+    // flight. begin_frame rewinds the frame's chain once its fence signalled, everything written during the frame is
+    // read through dynamic offsets into those buffers, so nothing is copied or flushed and there is no size ceiling per
+    // draw like with push constants. When a frame outgrows its buffers another one is chained on instead of failing,
+    // it stays for later frames, so only the first frame of a bigger scene creates buffers.
+    class frame_allocator final : public singleton<frame_allocator>
+    {
+    public:
+        struct allocation
+        {
+            void           *data       = nullptr;
+            uint32_t        offset     = 0;              // dynamic offset into the buffer
+            VkDescriptorSet object_set = VK_NULL_HANDLE; // set 1 of the drawing systems, bound to that buffer
+        };
+
+        struct statistics
+        {
+            VkDeviceSize capacity    = 0; // of every buffer of every frame
+            uint64_t     buffers     = 0; // of every frame
+            uint64_t     allocations = 0; // in the current frame
+            VkDeviceSize used_bytes  = 0; // in the current frame
+            VkDeviceSize peak_bytes  = 0; // over every frame so far
+        };
+
+        ~frame_allocator() override = default;
+
+        frame_allocator(frame_allocator const &)            = delete;
+        frame_allocator(frame_allocator &&)                 = delete;
+        frame_allocator &operator=(frame_allocator const &) = delete;
+        frame_allocator &operator=(frame_allocator &&)      = delete;
+
+        // The device finished the frame's previous submission, its buffers start over
+        void begin_frame(int frame_index);
+
+        // Aligned for both uniform and storage descriptors, valid until the frame comes around again
+        auto allocate(VkDeviceSize size) -> allocation;
+
+        // Per-object data, bound with the returned set at the returned offset
+        template <typename T>
+        auto push_object(T const &value) -> allocation
+        {
+            static_assert(sizeof(T) <= object_range);
+            allocation const slot = allocate(sizeof(T));
+            std::memcpy(slot.data, &value, sizeof(T));
+            return slot;
+        }
+
+        // Data read through descriptor_info, which only covers the frame's first buffer, so this has to come before
+        // the frame's objects fill it
+        template <typename T>
+        auto push(T const &value) -> uint32_t
+        {
+            allocation const slot = allocate(sizeof(T));
+            assert(slot.object_set == frames_[frame_index_].front().object_set and "Pushed past the frame's first buffer");
+            std::memcpy(slot.data, &value, sizeof(T));
+            return slot.offset;
+        }
+
+        // Range of a frame's first buffer for descriptors of other sets, bound with the offsets push hands out
+        [[nodiscard]] auto descriptor_info(int frame_index, VkDeviceSize range) const -> VkDescriptorBufferInfo;
+
+        // Set 1 of the systems drawing objects, binding 0 is a dynamic uniform buffer of object_range bytes
+        [[nodiscard]] auto object_set_layout() const -> VkDescriptorSetLayout { return object_set_layout_->get_descriptor_set_layout(); }
+
+        [[nodiscard]] auto stats() const -> statistics { return stats_; }
+
+        // Size of every buffer, a frame chains on as many as it needs
+        static constexpr VkDeviceSize buffer_capacity = 4ull << 20;
+        static constexpr VkDeviceSize object_range    = 256;
+
+    private:
+        friend class singleton<frame_allocator>;
+        frame_allocator();
+
+        struct frame_buffer
+        {
+            std::unique_ptr<buffer>          buffer     = {};
+            std::unique_ptr<descriptor_pool> pool       = {};
+            VkDescriptorSet                  object_set = VK_NULL_HANDLE;
+        };
+
+        void add_buffer(int frame_index);
+
+        std::vector<std::vector<frame_buffer>> frames_            = {};
+        std::unique_ptr<descriptor_set_layout> object_set_layout_ = {};
+
+        VkDeviceSize alignment_    = 0;
+        VkDeviceSize head_         = 0; // in the current buffer
+        size_t       buffer_index_ = 0; // in the frame's chain
+        int          frame_index_  = 0;
+        statistics   stats_        = {};
+    };
+}
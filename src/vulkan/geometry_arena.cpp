@@ -0,0 +1,280 @@
+﻿#include "geometry_arena.h"
+
+// Project includes
+#include "src/utility/utils.h"
+#include "src/vulkan/device.h"
+#include "src/vulkan/upload_batch.h"
+
+// Standard includes
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace dae
+{
+    geometry_arena::~geometry_arena() = default;
+
+    auto geometry_arena::allocate(usage usage, uint32_t element_size, uint32_t element_count, void const *data) -> handle
+    {
+        assert(element_size > 0 and element_count > 0 and "Empty geometry allocation");
+
+        uint32_t const pool_index = find_or_create_pool(usage, element_size, element_count);
+
+        std::optional<uint32_t> offset = take_range(pools_[pool_index], element_count);
+        if (not offset)
+        {
+            // Fragmented but large enough: packing the live ranges leaves one free range at the end, otherwise grow
+            pool const    &pool     = pools_[pool_index];
+            uint64_t const capacity = pool.capacity - pool.used >= element_count
+                ? pool.capacity
+                : std::max<uint64_t>(uint64_t{pool.capacity} * 2, uint64_t{pool.used} + element_count);
+            if (capacity > std::numeric_limits<uint32_t>::max())
+            {
+                throw std::runtime_error{"Geometry arena pool exceeds 2^32 elements"};
+            }
+
+            relocate(pool_index, static_cast<uint32_t>(capacity));
+            offset = take_range(pools_[pool_index], element_count);
+            assert(offset and "A relocated pool fits the allocation");
+        }
+
+        pool &pool = pools_[pool_index];
+        VkDeviceSize const size = VkDeviceSize{element_size} * element_count;
+
+        auto &device = device::instance();
+        auto staging = device.staging().allocate(size);
+        std::memcpy(staging.mapped, data, size);
+
+        VkCommandBuffer command_buffer = device.begin_single_time_commands();
+
+        VkBufferCopy copy_region{};
+        copy_region.srcOffset = staging.offset;
+        copy_region.dstOffset = VkDeviceSize{element_size} * *offset;
+        copy_region.size      = size;
+        vkCmdCopyBuffer(command_buffer, staging.buffer, pool.buffer->get_buffer(), 1, &copy_region);
+
+        device.end_single_time_commands(command_buffer);
+        if (staging.dedicated)
+        {
+            upload_batch::retire(std::move(staging.dedicated));
+        }
+
+        handle result{};
+        if (not free_records_.empty())
+        {
+            result.id = free_records_.back();
+            free_records_.pop_back();
+        }
+        else
+        {
+            result.id = static_cast<uint32_t>(records_.size());
+            records_.emplace_back();
+        }
+
+        records_[result.id] = {pool_index, *offset, element_count, true};
+        return result;
+    }
+
+    void geometry_arena::free(handle handle)
+    {
+        if (not handle.valid())
+        {
+            return;
+        }
+
+        record &record = records_[handle.id];
+        assert(record.live and "Geometry range freed twice");
+
+        release_range(pools_[record.pool], {record.offset, record.count});
+        record.live = false;
+        free_records_.push_back(handle.id);
+    }
+
+    auto geometry_arena::size_in_bytes(handle handle) const -> VkDeviceSize
+    {
+        record const &record = records_[handle.id];
+        return VkDeviceSize{pools_[record.pool].element_size} * record.count;
+    }
+
+    void geometry_arena::compact()
+    {
+        for (uint32_t pool_index = 0; pool_index < pools_.size(); ++pool_index)
+        {
+            pool const &pool = pools_[pool_index];
+            bool const packed = pool.free_ranges.empty() or (pool.free_ranges.size() == 1 and pool.free_ranges[0].offset == pool.used);
+            if (not packed)
+            {
+                relocate(pool_index, pool.capacity);
+            }
+        }
+    }
+
+    auto geometry_arena::stats() const -> statistics
+    {
+        statistics result{};
+        for (auto const &pool : pools_)
+        {
+            result.capacity_bytes += VkDeviceSize{pool.element_size} * pool.capacity;
+            result.used_bytes     += VkDeviceSize{pool.element_size} * pool.used;
+        }
+        result.live_allocations   = records_.size() - free_records_.size();
+        result.pools              = pools_.size();
+        result.compactions        = compactions_;
+        result.buffer_allocations = buffer_allocations_;
+        return result;
+    }
+
+    auto geometry_arena::find_or_create_pool(usage usage, uint32_t element_size, uint32_t min_capacity) -> uint32_t
+    {
+        auto const it = std::ranges::find_if(pools_, [usage, element_size](pool const &pool)
+        {
+            return pool.usage == usage and pool.element_size == element_size;
+        });
+        if (it != pools_.end())
+        {
+            return static_cast<uint32_t>(it - pools_.begin());
+        }
+
+        uint32_t const capacity = std::max(min_capacity, static_cast<uint32_t>(initial_pool_bytes / element_size));
+
+        pool &pool        = pools_.emplace_back();
+        pool.usage        = usage;
+        pool.element_size = element_size;
+        pool.capacity     = capacity;
+        pool.buffer       = create_pool_buffer(usage, element_size, capacity);
+        pool.free_ranges.push_back({0, capacity});
+        return static_cast<uint32_t>(pools_.size() - 1);
+    }
+
+    auto geometry_arena::create_pool_buffer(usage usage, uint32_t element_size, uint32_t capacity) -> std::unique_ptr<buffer>
+    {
+        ++buffer_allocations_;
+
+        // Shared with the transfer queue: uploads and relocations rewrite freed ranges there while the graphics queue
+        // draws from the rest, per range ownership transfers would have to follow every free-list change
+        VkBufferUsageFlags const binding = usage == usage::vertex ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        return std::make_unique<buffer>(
+            element_size,
+            capacity,
+            binding | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            1,
+            true
+        );
+    }
+
+    auto geometry_arena::take_range(pool &pool, uint32_t count) -> std::optional<uint32_t>
+    {
+        auto const it = std::ranges::find_if(pool.free_ranges, [count](range const &range) { return range.count >= count; });
+        if (it == pool.free_ranges.end())
+        {
+            return std::nullopt;
+        }
+
+        uint32_t const offset = it->offset;
+        it->offset += count;
+        it->count  -= count;
+        if (it->count == 0)
+        {
+            pool.free_ranges.erase(it);
+        }
+
+        pool.used += count;
+        return offset;
+    }
+
+    void geometry_arena::release_range(pool &pool, range released)
+    {
+        pool.used -= released.count;
+
+        auto next = std::ranges::lower_bound(pool.free_ranges, released.offset, {}, &range::offset);
+        if (next != pool.free_ranges.begin())
+        {
+            auto const previous = std::prev(next);
+            if (previous->offset + previous->count == released.offset)
+            {
+                released.offset  = previous->offset;
+                released.count  += previous->count;
+                next = pool.free_ranges.erase(previous);
+            }
+        }
+        if (next != pool.free_ranges.end() and released.offset + released.count == next->offset)
+        {
+            released.count += next->count;
+            next = pool.free_ranges.erase(next);
+        }
+        pool.free_ranges.insert(next, released);
+    }
+
+    void geometry_arena::relocate(uint32_t pool_index, uint32_t new_capacity)
+    {
+        pool &pool = pools_[pool_index];
+
+        // Live ranges keep their relative order, so each moves to a lower or equal offset
+        std::vector<uint32_t> moved{};
+        for (uint32_t id = 0; id < records_.size(); ++id)
+        {
+            if (records_[id].live and records_[id].pool == pool_index)
+            {
+                moved.push_back(id);
+            }
+        }
+        std::ranges::sort(moved, {}, [this](uint32_t id) { return records_[id].offset; });
+
+        auto new_buffer = create_pool_buffer(pool.usage, pool.element_size, new_capacity);
+
+        std::vector<VkBufferCopy> regions{};
+        regions.reserve(moved.size());
+        uint32_t packed_offset = 0;
+        for (uint32_t const id : moved)
+        {
+            record &record = records_[id];
+            regions.push_back({
+                VkDeviceSize{pool.element_size} * record.offset,
+                VkDeviceSize{pool.element_size} * packed_offset,
+                VkDeviceSize{pool.element_size} * record.count
+            });
+            record.offset  = packed_offset;
+            packed_offset += record.count;
+        }
+
+        auto &device = device::instance();
+
+        // Frames still in flight may read the old buffer
+        vkDeviceWaitIdle(device.logical_device());
+        if (not regions.empty())
+        {
+            VkCommandBuffer command_buffer = device.begin_single_time_commands();
+
+            // Inside an upload batch earlier copies into the old buffer are still pending in the same command buffer
+            VkMemoryBarrier barrier{};
+            barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+            vkCmdCopyBuffer(command_buffer, pool.buffer->get_buffer(), new_buffer->get_buffer(), static_cast<uint32_t>(regions.size()), regions.data());
+            device.end_single_time_commands(command_buffer);
+        }
+
+#ifndef NDEBUG
+        std::cout << YELLOW_TEXT("[Geometry Arena]\n") << ONE_TAB << (new_capacity > pool.capacity ? "grew " : "compacted ")
+                  << (pool.usage == usage::vertex ? "vertex" : "index") << " pool of " << pool.element_size << " byte elements, "
+                  << moved.size() << " ranges, " << VkDeviceSize{pool.element_size} * new_capacity / 1024 << " KiB" << '\n';
+#endif
+
+        upload_batch::retire(std::move(pool.buffer));
+        pool.buffer   = std::move(new_buffer);
+        pool.capacity = new_capacity;
+        pool.used     = packed_offset;
+        pool.free_ranges.clear();
+        if (packed_offset < new_capacity)
+        {
+            pool.free_ranges.push_back({packed_offset, new_capacity - packed_offset});
+        }
+        ++compactions_;
+    }
+}
@@ -0,0 +1,115 @@
+﻿#pragma once
+
+// Project includes
+#include "src/utility/singleton.h"
+#include "src/vulkan/buffer.h"
+
+// Standard includes
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+// Vulkan includes
+#include <vulkan/vulkan.h>
+
+namespace dae
+{
+    // Large device-local vertex and index buffers that models suballocate from.
+    // There is one pool per usage and element size, so every range in a pool can be addressed with
+    // vkCmdDrawIndexed's firstIndex and vertexOffset while the pool's buffer stays bound.
+    // Ranges come from a first-fit free-list, compaction and growth move them into a fresh buffer.
+    class geometry_arena final : public singleton<geometry_arena>
+    {
+    public:
+        enum class usage : uint8_t
+        {
+            vertex,
+            index,
+        };
+
+        // Stable across compaction, the element offset it resolves to is not
+        struct handle
+        {
+            uint32_t id = UINT32_MAX;
+
+            [[nodiscard]] auto valid() const -> bool { return id != UINT32_MAX; }
+        };
+
+        struct statistics
+        {
+            VkDeviceSize capacity_bytes     = 0;
+            VkDeviceSize used_bytes         = 0;
+            uint64_t     live_allocations   = 0;
+            uint64_t     pools              = 0;
+            uint64_t     compactions        = 0;
+            uint64_t     buffer_allocations = 0; // buffers the arena created, pools and compaction targets
+        };
+
+        ~geometry_arena() override;
+
+        geometry_arena(geometry_arena const &)            = delete;
+        geometry_arena(geometry_arena &&)                 = delete;
+        geometry_arena &operator=(geometry_arena const &) = delete;
+        geometry_arena &operator=(geometry_arena &&)      = delete;
+
+        // Uploads element_count elements of element_size bytes through the device's staging ring
+        auto allocate(usage usage, uint32_t element_size, uint32_t element_count, void const *data) -> handle;
+        void free(handle handle);
+
+        [[nodiscard]] auto first_element(handle handle) const -> uint32_t { return records_[handle.id].offset; }
+        [[nodiscard]] auto element_count(handle handle) const -> uint32_t { return records_[handle.id].count; }
+        [[nodiscard]] auto buffer_of(handle handle) const -> VkBuffer { return pools_[records_[handle.id].pool].buffer->get_buffer(); }
+        [[nodiscard]] auto size_in_bytes(handle handle) const -> VkDeviceSize;
+
+        // Packs every pool's live ranges to the front, waits for the device so no frame reads the old buffers
+        void compact();
+
+        [[nodiscard]] auto stats() const -> statistics;
+
+        static constexpr VkDeviceSize initial_pool_bytes = VkDeviceSize{16} << 20;
+
+    private:
+        friend class singleton<geometry_arena>;
+        geometry_arena() = default;
+
+        struct range
+        {
+            uint32_t offset = 0;
+            uint32_t count  = 0;
+        };
+
+        struct pool
+        {
+            usage                   usage        = usage::vertex;
+            uint32_t                element_size = 0;
+            uint32_t                capacity     = 0;
+            uint32_t                used         = 0;
+            std::unique_ptr<buffer> buffer       = nullptr;
+            std::vector<range>      free_ranges  = {}; // sorted by offset, neighbours always merged
+        };
+
+        struct record
+        {
+            uint32_t pool   = 0;
+            uint32_t offset = 0;
+            uint32_t count  = 0;
+            bool     live   = false;
+        };
+
+        auto find_or_create_pool(usage usage, uint32_t element_size, uint32_t min_capacity) -> uint32_t;
+        auto create_pool_buffer(usage usage, uint32_t element_size, uint32_t capacity) -> std::unique_ptr<buffer>;
+        static auto take_range(pool &pool, uint32_t count) -> std::optional<uint32_t>;
+        static void release_range(pool &pool, range released);
+
+        // Copies the pool's live ranges back to back into a new buffer of new_capacity elements
+        void relocate(uint32_t pool_index, uint32_t new_capacity);
+
+        std::vector<pool>     pools_        = {};
+        std::vector<record>   records_      = {};
+        std::vector<uint32_t> free_records_ = {};
+
+        uint64_t compactions_        = 0;
+        uint64_t buffer_allocations_ = 0;
+    };
+}
@@ -0,0 +1,433 @@
+﻿#include "memory_allocator.h"
+
+// Standard includes
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+
+namespace dae
+{
+    namespace
+    {
+        auto round_up(VkDeviceSize value, VkDeviceSize alignment) -> VkDeviceSize
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    memory_allocator::memory_allocator(VkDevice device, VkPhysicalDevice physical_device)
+        : device_{device}
+    {
+        vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties_);
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(physical_device, &properties);
+        non_coherent_atom_size_ = std::max<VkDeviceSize>(1, properties.limits.nonCoherentAtomSize);
+
+        pools_.resize(memory_properties_.memoryTypeCount * 2);
+        for (uint32_t i = 0; i < pools_.size(); ++i)
+        {
+            pools_[i].memory_type = i / 2;
+        }
+    }
+
+    memory_allocator::~memory_allocator()
+    {
+        for (auto const &pool : pools_)
+        {
+            for (auto const &block : pool.blocks)
+            {
+                free_memory(block->memory, block->size, pool.memory_type);
+            }
+        }
+    }
+
+    auto memory_allocator::allocate(VkMemoryRequirements const &requirements, uint32_t memory_type, resource_kind kind, memory_category category) -> allocation
+    {
+        // Flushed ranges of non-coherent memory have to cover whole atoms, so the allocation starts and ends on one
+        VkDeviceSize alignment = std::max(requirements.alignment, granularity);
+        VkDeviceSize size      = round_up(requirements.size, granularity);
+        if (is_host_visible(memory_type) and not (memory_properties_.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        {
+            alignment = std::max(alignment, non_coherent_atom_size_);
+            size      = round_up(size, non_coherent_atom_size_);
+        }
+
+        // Lazily allocated memory is only committed for the tiles an attachment touches, a block of it would be pointless
+        VkDeviceSize const pool_block_size = block_size_for(memory_type);
+        bool const lazy = memory_properties_.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        if (lazy or (kind == resource_kind::optimal and size >= dedicated_image_size) or size > pool_block_size / 2)
+        {
+            allocation result{};
+            result.memory      = allocate_memory(size, memory_type, &result.mapped);
+            result.size        = size;
+            result.memory_type = memory_type;
+            result.category    = category;
+            ++dedicated_;
+            dedicated_bytes_ += size;
+
+            auto &usage = categories_[static_cast<size_t>(category)];
+            usage.bytes += size;
+            ++usage.allocations;
+            return result;
+        }
+
+        pool &pool = pools_[memory_type * 2 + static_cast<uint32_t>(kind)];
+
+        std::optional<uint32_t> index{};
+        block                  *target = nullptr;
+        for (auto const &candidate : pool.blocks)
+        {
+            if ((index = allocate_from(*candidate, size, alignment)))
+            {
+                target = candidate.get();
+                break;
+            }
+        }
+
+        if (not target)
+        {
+            auto created = std::make_unique<block>();
+            void *mapped = nullptr;
+            created->memory = allocate_memory(pool_block_size, memory_type, &mapped);
+            created->size   = pool_block_size;
+            created->mapped = static_cast<std::byte *>(mapped);
+            created->free_heads.fill(no_node);
+            insert_free(*created, new_node(*created, {0, pool_block_size}));
+
+            target = pool.blocks.emplace_back(std::move(created)).get();
+            index  = allocate_from(*target, size, alignment);
+            assert(index and "A new block fits every suballocation");
+        }
+
+        node const &range = target->nodes[*index];
+        ++target->live_allocations;
+        target->used += range.size;
+
+        auto &usage = categories_[static_cast<size_t>(category)];
+        usage.bytes += range.size;
+        ++usage.allocations;
+
+        allocation result{};
+        result.memory      = target->memory;
+        result.offset      = range.offset;
+        result.size        = range.size;
+        result.mapped      = target->mapped ? target->mapped + range.offset : nullptr;
+        result.owner       = target;
+        result.node        = *index;
+        result.memory_type = memory_type;
+        result.category    = category;
+        return result;
+    }
+
+    void memory_allocator::free(allocation &allocation)
+    {
+        if (not allocation.valid())
+        {
+            return;
+        }
+
+        auto &usage = categories_[static_cast<size_t>(allocation.category)];
+        usage.bytes -= allocation.size;
+        --usage.allocations;
+
+        if (not allocation.owner)
+        {
+            free_memory(allocation.memory, allocation.size, allocation.memory_type);
+            --dedicated_;
+            dedicated_bytes_ -= allocation.size;
+            allocation = {};
+            return;
+        }
+
+        block &owner = *allocation.owner;
+        owner.used -= owner.nodes[allocation.node].size;
+        --owner.live_allocations;
+        release(owner, allocation.node);
+
+        // Empty blocks go back to the driver, except the last one of a pool so a free and allocate pair does not thrash
+        if (owner.live_allocations == 0)
+        {
+            for (auto &pool : pools_)
+            {
+                auto const it = std::find_if(pool.blocks.begin(), pool.blocks.end(), [&](auto const &candidate) { return candidate.get() == &owner; });
+                if (it != pool.blocks.end())
+                {
+                    if (pool.blocks.size() > 1)
+                    {
+                        free_memory(owner.memory, owner.size, pool.memory_type);
+                        pool.blocks.erase(it);
+                    }
+                    break;
+                }
+            }
+        }
+        allocation = {};
+    }
+
+    auto memory_allocator::stats() const -> statistics
+    {
+        statistics result{};
+        result.dedicated       = dedicated_;
+        result.allocate_calls  = allocate_calls_;
+        result.reserved_bytes  = dedicated_bytes_;
+        result.used_bytes      = dedicated_bytes_;
+        result.live_allocations = dedicated_;
+
+        VkDeviceSize largest_per_block = 0;
+        for (auto const &pool : pools_)
+        {
+            for (auto const &block : pool.blocks)
+            {
+                ++result.blocks;
+                result.reserved_bytes   += block->size;
+                result.used_bytes       += block->used;
+                result.free_bytes       += block->size - block->used;
+                result.live_allocations += block->live_allocations;
+
+                VkDeviceSize largest = 0;
+                for (auto const &range : block->nodes)
+                {
+                    if (range.free)
+                    {
+                        largest = std::max(largest, range.size);
+                    }
+                }
+                largest_per_block         += largest;
+                result.largest_free_range  = std::max(result.largest_free_range, largest);
+            }
+        }
+
+        result.memory_objects = result.blocks + result.dedicated;
+        if (result.free_bytes > 0)
+        {
+            result.fragmentation = 1.0f - static_cast<float>(largest_per_block) / static_cast<float>(result.free_bytes);
+        }
+        return result;
+    }
+
+    auto memory_allocator::allocate_memory(VkDeviceSize size, uint32_t memory_type, void **mapped) -> VkDeviceMemory
+    {
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize  = size;
+        alloc_info.memoryTypeIndex = memory_type;
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        if (vkAllocateMemory(device_, &alloc_info, nullptr, &memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate device memory!");
+        }
+        ++allocate_calls_;
+        heap_bytes_[memory_properties_.memoryTypes[memory_type].heapIndex] += size;
+
+        *mapped = nullptr;
+        if (is_host_visible(memory_type))
+        {
+            vkMapMemory(device_, memory, 0, VK_WHOLE_SIZE, 0, mapped);
+        }
+        return memory;
+    }
+
+    void memory_allocator::free_memory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memory_type)
+    {
+        vkFreeMemory(device_, memory, nullptr);
+        heap_bytes_[memory_properties_.memoryTypes[memory_type].heapIndex] -= size;
+    }
+
+    auto memory_allocator::block_size_for(uint32_t memory_type) const -> VkDeviceSize
+    {
+        // Small heaps, such as the 256 MiB device local and host visible one, should not be claimed by a few blocks
+        VkDeviceSize const heap_size = memory_properties_.memoryHeaps[memory_properties_.memoryTypes[memory_type].heapIndex].size;
+        return std::clamp(std::bit_floor(heap_size / 8), granularity * second_level_count, block_size);
+    }
+
+    auto memory_allocator::is_host_visible(uint32_t memory_type) const -> bool
+    {
+        return memory_properties_.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    }
+
+    // First level is the highest set bit, second level the bits right below it
+    auto memory_allocator::bin(VkDeviceSize size) -> std::pair<uint32_t, uint32_t>
+    {
+        auto const first  = static_cast<uint32_t>(std::bit_width(size) - 1);
+        auto const second = static_cast<uint32_t>(size >> (first - second_level_bits)) & (second_level_count - 1);
+        return {first, second};
+    }
+
+    auto memory_allocator::find_free(block const &block, VkDeviceSize size) -> uint32_t
+    {
+        // Rounded up to the next bin so any range found there fits without walking the list
+        auto const [exact_first, exact_second] = bin(size);
+        auto [first, second] = bin(size + (VkDeviceSize{1} << (exact_first - second_level_bits)) - 1);
+
+        uint32_t second_map = first < first_level_count ? block.second_level_bitmaps[first] & (~0u << second) : 0;
+        if (second_map == 0)
+        {
+            uint64_t const first_map = first + 1 < first_level_count ? block.first_level_bitmap & (~uint64_t{0} << (first + 1)) : 0;
+            if (first_map != 0)
+            {
+                first      = static_cast<uint32_t>(std::countr_zero(first_map));
+                second_map = block.second_level_bitmaps[first];
+            }
+        }
+
+        if (second_map != 0)
+        {
+            return block.free_heads[first * second_level_count + std::countr_zero(second_map)];
+        }
+
+        // Ranges in the request's own bin may still fit, they are only skipped by the fast path
+        for (uint32_t index = block.free_heads[exact_first * second_level_count + exact_second]; index != no_node; index = block.nodes[index].next_free)
+        {
+            if (block.nodes[index].size >= size)
+            {
+                return index;
+            }
+        }
+        return no_node;
+    }
+
+    auto memory_allocator::allocate_from(block &block, VkDeviceSize size, VkDeviceSize alignment) -> std::optional<uint32_t>
+    {
+        // Offsets are multiples of the granularity, so at most alignment - granularity bytes go to padding
+        VkDeviceSize const needed = size + (alignment > granularity ? alignment - granularity : 0);
+        if (needed > block.size)
+        {
+            return std::nullopt;
+        }
+
+        uint32_t const index = find_free(block, needed);
+        if (index == no_node)
+        {
+            return std::nullopt;
+        }
+        remove_free(block, index);
+
+        // Padding in front stays free as a range of its own
+        VkDeviceSize const aligned = round_up(block.nodes[index].offset, alignment);
+        if (aligned != block.nodes[index].offset)
+        {
+            node const current = block.nodes[index];
+            uint32_t const padding = new_node(block, {current.offset, aligned - current.offset, current.prev_physical, index});
+            if (current.prev_physical != no_node)
+            {
+                block.nodes[current.prev_physical].next_physical = padding;
+            }
+            block.nodes[index].prev_physical = padding;
+            block.nodes[index].offset        = aligned;
+            block.nodes[index].size         -= aligned - current.offset;
+            insert_free(block, padding);
+        }
+
+        if (block.nodes[index].size > size)
+        {
+            node const current = block.nodes[index];
+            uint32_t const rest = new_node(block, {current.offset + size, current.size - size, index, current.next_physical});
+            if (current.next_physical != no_node)
+            {
+                block.nodes[current.next_physical].prev_physical = rest;
+            }
+            block.nodes[index].next_physical = rest;
+            block.nodes[index].size          = size;
+            insert_free(block, rest);
+        }
+
+        block.nodes[index].free = false;
+        return index;
+    }
+
+    void memory_allocator::release(block &block, uint32_t index)
+    {
+        auto const merge = [&block](uint32_t first, uint32_t second)
+        {
+            node const absorbed = block.nodes[second];
+            block.nodes[first].size         += absorbed.size;
+            block.nodes[first].next_physical = absorbed.next_physical;
+            if (absorbed.next_physical != no_node)
+            {
+                block.nodes[absorbed.next_physical].prev_physical = first;
+            }
+            block.nodes[second] = {};
+            block.unused_nodes.push_back(second);
+        };
+
+        if (uint32_t const next = block.nodes[index].next_physical; next != no_node and block.nodes[next].free)
+        {
+            remove_free(block, next);
+            merge(index, next);
+        }
+        if (uint32_t const prev = block.nodes[index].prev_physical; prev != no_node and block.nodes[prev].free)
+        {
+            remove_free(block, prev);
+            merge(prev, index);
+            index = prev;
+        }
+        insert_free(block, index);
+    }
+
+    auto memory_allocator::new_node(block &block, node const &value) -> uint32_t
+    {
+        if (not block.unused_nodes.empty())
+        {
+            uint32_t const index = block.unused_nodes.back();
+            block.unused_nodes.pop_back();
+            block.nodes[index] = value;
+            return index;
+        }
+        block.nodes.push_back(value);
+        return static_cast<uint32_t>(block.nodes.size() - 1);
+    }
+
+    void memory_allocator::insert_free(block &block, uint32_t index)
+    {
+        auto const [first, second] = bin(block.nodes[index].size);
+        uint32_t &head = block.free_heads[first * second_level_count + second];
+
+        node &range = block.nodes[index];
+        range.free      = true;
+        range.prev_free = no_node;
+        range.next_free = head;
+        if (head != no_node)
+        {
+            block.nodes[head].prev_free = index;
+        }
+        head = index;
+
+        block.first_level_bitmap          |= uint64_t{1} << first;
+        block.second_level_bitmaps[first] |= 1u << second;
+    }
+
+    void memory_allocator::remove_free(block &block, uint32_t index)
+    {
+        node &range = block.nodes[index];
+        auto const [first, second] = bin(range.size);
+        uint32_t &head = block.free_heads[first * second_level_count + second];
+
+        if (range.prev_free != no_node)
+        {
+            block.nodes[range.prev_free].next_free = range.next_free;
+        }
+        else
+        {
+            head = range.next_free;
+        }
+        if (range.next_free != no_node)
+        {
+            block.nodes[range.next_free].prev_free = range.prev_free;
+        }
+        range.free      = false;
+        range.prev_free = no_node;
+        range.next_free = no_node;
+
+        if (head == no_node)
+        {
+            block.second_level_bitmaps[first] &= ~(1u << second);
+            if (block.second_level_bitmaps[first] == 0)
+            {
+                block.first_level_bitmap &= ~(uint64_t{1} << first);
+            }
+        }
+    }
+}
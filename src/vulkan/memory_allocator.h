@@ -0,0 +1,168 @@
+﻿#pragma once
+
+// Standard includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Vulkan includes
+#include <vulkan/vulkan.h>
+
+namespace dae
+{
+    // What an allocation is used for, every category is accounted separately
+    enum class memory_category : uint8_t
+    {
+        mesh,
+        texture,
+        staging,
+        uniform,
+        depth,
+        other,
+        count,
+    };
+
+    // Suballocates buffers and images from large blocks of device memory, one list of blocks per memory type and
+    // resource kind, with a TLSF allocator inside every block. Buffers and optimal images never share a block, so
+    // neighbouring resources are always at least bufferImageGranularity apart without tracking pages. Images above
+    // dedicated_image_size, anything larger than half a block and lazily allocated attachments get a VkDeviceMemory
+    // of their own. Host visible blocks stay mapped for their whole lifetime.
+    class memory_allocator final
+    {
+    public:
+        enum class resource_kind : uint8_t
+        {
+            linear,  // buffers and linear images
+            optimal, // optimal tiling images
+        };
+
+        struct block;
+
+        // Range a buffer or image is bound to, held in place of its VkDeviceMemory
+        struct allocation
+        {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize   offset = 0;
+            VkDeviceSize   size   = 0;
+            void          *mapped = nullptr; // start of the range for host visible memory
+
+            block          *owner       = nullptr; // nullptr for dedicated allocations
+            uint32_t        node        = 0;
+            uint32_t        memory_type = 0;
+            memory_category category    = memory_category::other;
+
+            [[nodiscard]] auto valid() const -> bool { return memory != VK_NULL_HANDLE; }
+        };
+
+        struct statistics
+        {
+            uint64_t     memory_objects     = 0; // live VkDeviceMemory, blocks and dedicated allocations
+            uint64_t     blocks             = 0;
+            uint64_t     dedicated          = 0;
+            uint64_t     live_allocations   = 0;
+            uint64_t     allocate_calls     = 0; // vkAllocateMemory calls since creation
+            VkDeviceSize reserved_bytes     = 0;
+            VkDeviceSize used_bytes         = 0;
+            VkDeviceSize free_bytes         = 0; // unused space inside blocks
+            VkDeviceSize largest_free_range = 0;
+            float        fragmentation      = 0.0f; // share of the free bytes outside each block's largest free range
+        };
+
+        struct category_usage
+        {
+            VkDeviceSize bytes       = 0;
+            uint64_t     allocations = 0;
+        };
+
+        memory_allocator(VkDevice device, VkPhysicalDevice physical_device);
+        ~memory_allocator();
+
+        memory_allocator(memory_allocator const &)            = delete;
+        memory_allocator(memory_allocator &&)                 = delete;
+        memory_allocator &operator=(memory_allocator const &) = delete;
+        memory_allocator &operator=(memory_allocator &&)      = delete;
+
+        auto allocate(VkMemoryRequirements const &requirements, uint32_t memory_type, resource_kind kind, memory_category category) -> allocation;
+        void free(allocation &allocation);
+
+        [[nodiscard]] auto stats() const -> statistics;
+        [[nodiscard]] auto usage(memory_category category) const -> category_usage { return categories_[static_cast<size_t>(category)]; }
+        [[nodiscard]] auto memory_properties() const -> VkPhysicalDeviceMemoryProperties const & { return memory_properties_; }
+
+        // VkDeviceMemory the allocator holds in a heap, blocks count whole
+        [[nodiscard]] auto heap_bytes(uint32_t heap) const -> VkDeviceSize { return heap_bytes_[heap]; }
+
+        static constexpr VkDeviceSize block_size           = 64ull << 20; // smaller on heaps below eight blocks
+        static constexpr VkDeviceSize dedicated_image_size = 8ull << 20;  // render target sized and up
+
+    private:
+        static constexpr uint32_t     second_level_bits  = 4; // 16 bins per power of two
+        static constexpr uint32_t     second_level_count = 1u << second_level_bits;
+        static constexpr uint32_t     first_level_count  = 64;
+        static constexpr VkDeviceSize granularity        = 256; // every offset and size is a multiple
+        static constexpr uint32_t     no_node            = UINT32_MAX;
+
+        struct node
+        {
+            VkDeviceSize offset        = 0;
+            VkDeviceSize size          = 0;
+            uint32_t     prev_physical = no_node;
+            uint32_t     next_physical = no_node;
+            uint32_t     prev_free     = no_node;
+            uint32_t     next_free     = no_node;
+            bool         free          = false;
+        };
+
+        struct pool
+        {
+            uint32_t                            memory_type = 0;
+            std::vector<std::unique_ptr<block>> blocks      = {};
+        };
+
+        auto allocate_memory(VkDeviceSize size, uint32_t memory_type, void **mapped) -> VkDeviceMemory;
+        void free_memory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memory_type);
+        auto block_size_for(uint32_t memory_type) const -> VkDeviceSize;
+        auto is_host_visible(uint32_t memory_type) const -> bool;
+
+        static auto bin(VkDeviceSize size) -> std::pair<uint32_t, uint32_t>;
+        static auto find_free(block const &block, VkDeviceSize size) -> uint32_t;
+        static auto allocate_from(block &block, VkDeviceSize size, VkDeviceSize alignment) -> std::optional<uint32_t>;
+        static void release(block &block, uint32_t index);
+        static auto new_node(block &block, node const &value) -> uint32_t;
+        static void insert_free(block &block, uint32_t index);
+        static void remove_free(block &block, uint32_t index);
+
+        VkDevice                         device_                 = VK_NULL_HANDLE;
+        VkPhysicalDeviceMemoryProperties memory_properties_      = {};
+        VkDeviceSize                     non_coherent_atom_size_ = 1;
+
+        std::vector<pool> pools_           = {}; // memory type * 2 + resource kind
+        uint64_t          dedicated_       = 0;
+        VkDeviceSize      dedicated_bytes_ = 0;
+        uint64_t          allocate_calls_  = 0;
+
+        std::array<category_usage, static_cast<size_t>(memory_category::count)> categories_ = {};
+        std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>                            heap_bytes_ = {};
+    };
+
+    struct memory_allocator::block
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize   size   = 0;
+        std::byte     *mapped = nullptr;
+
+        std::vector<node>     nodes        = {};
+        std::vector<uint32_t> unused_nodes = {};
+
+        uint64_t                                                    first_level_bitmap   = 0;
+        std::array<uint32_t, first_level_count>                     second_level_bitmaps = {};
+        std::array<uint32_t, first_level_count * second_level_count> free_heads          = {};
+
+        uint32_t     live_allocations = 0;
+        VkDeviceSize used             = 0;
+    };
+}
@@ -0,0 +1,214 @@
+﻿#include "memory_budget.h"
+
+// Project includes
+#include "src/engine/engine.h"
+#include "src/utility/utils.h"
+
+// Standard includes
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+// JSON includes
+#if defined(CMAKE_BUILD)
+#include <single_include/nlohmann/json.hpp>
+#else
+#include "json.hpp"
+#endif
+
+#if defined(CMAKE_BUILD)
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../../../"
+#endif
+#else
+#ifndef ENGINE_DIR
+#define ENGINE_DIR ""
+#endif
+#endif
+
+namespace dae
+{
+    memory_budget::memory_budget(VkPhysicalDevice physical_device, PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_memory_properties_2, memory_allocator const &allocator)
+        : physical_device_{physical_device}
+        , get_memory_properties_2_{get_memory_properties_2}
+        , allocator_ptr_{&allocator}
+    {
+    }
+
+    auto memory_budget::current() const -> snapshot
+    {
+        VkPhysicalDeviceMemoryProperties const &properties = allocator_ptr_->memory_properties();
+
+        snapshot result{};
+        result.budget_extension = get_memory_properties_2_ != nullptr;
+
+        // Budget and usage change with every allocation in the process, so they are queried each time
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties{};
+        if (result.budget_extension)
+        {
+            budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+            VkPhysicalDeviceMemoryProperties2 properties_2{};
+            properties_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            properties_2.pNext = &budget_properties;
+            get_memory_properties_2_(physical_device_, &properties_2);
+        }
+
+        result.heaps.resize(properties.memoryHeapCount);
+        for (uint32_t i = 0; i < properties.memoryHeapCount; ++i)
+        {
+            heap_snapshot &heap = result.heaps[i];
+            heap.size         = properties.memoryHeaps[i].size;
+            heap.engine_bytes = allocator_ptr_->heap_bytes(i);
+            heap.device_local = properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+            if (result.budget_extension)
+            {
+                heap.budget = budget_properties.heapBudget[i];
+                heap.usage  = budget_properties.heapUsage[i];
+            }
+            else
+            {
+                heap.budget = static_cast<VkDeviceSize>(static_cast<double>(heap.size) * estimated_budget_share);
+                heap.usage  = heap.engine_bytes;
+            }
+        }
+
+        for (size_t i = 0; i < category_count; ++i)
+        {
+            auto const usage = allocator_ptr_->usage(static_cast<memory_category>(i));
+            result.categories[i] = {usage.bytes, usage.allocations, soft_budgets_[i].bytes};
+        }
+        return result;
+    }
+
+    void memory_budget::set_soft_budget(memory_category category, VkDeviceSize bytes, callback on_exceeded)
+    {
+        soft_budgets_[static_cast<size_t>(category)] = {bytes, std::move(on_exceeded), false};
+    }
+
+    void memory_budget::set_report(float interval_seconds, std::string json_file_path)
+    {
+        report_interval_  = interval_seconds;
+        report_file_path_ = std::move(json_file_path);
+        since_report_     = 0.0f;
+    }
+
+    void memory_budget::update(float delta_time)
+    {
+        for (size_t i = 0; i < category_count; ++i)
+        {
+            soft_budget &budget = soft_budgets_[i];
+            if (budget.bytes == 0)
+            {
+                continue;
+            }
+
+            // Edge triggered, a category staying above its budget does not call back every frame
+            auto const category = static_cast<memory_category>(i);
+            VkDeviceSize const bytes = allocator_ptr_->usage(category).bytes;
+            bool const exceeded = bytes > budget.bytes;
+            if (exceeded and not budget.exceeded and budget.on_exceeded)
+            {
+                budget.on_exceeded(category, bytes, budget.bytes);
+            }
+            budget.exceeded = exceeded;
+        }
+
+        if (report_interval_ <= 0.0f)
+        {
+            return;
+        }
+
+        since_report_ += delta_time;
+        if (since_report_ >= report_interval_)
+        {
+            since_report_ = 0.0f;
+
+            auto const report = current();
+#ifndef NDEBUG
+            log(report);
+#endif
+            if (not report_file_path_.empty())
+            {
+                write_json(report, report_file_path_);
+            }
+        }
+    }
+
+    void memory_budget::write_json(snapshot const &snapshot, std::string const &file_path) const
+    {
+        nlohmann::json report{};
+        report["budget_extension"] = snapshot.budget_extension;
+
+        for (auto const &heap : snapshot.heaps)
+        {
+            report["heaps"].push_back({
+                {"size", heap.size},
+                {"budget", heap.budget},
+                {"usage", heap.usage},
+                {"engine_bytes", heap.engine_bytes},
+                {"device_local", heap.device_local},
+            });
+        }
+
+        for (size_t i = 0; i < category_count; ++i)
+        {
+            auto const &category = snapshot.categories[i];
+            report["categories"][category_name(static_cast<memory_category>(i))] = {
+                {"bytes", category.bytes},
+                {"allocations", category.allocations},
+                {"soft_budget", category.soft_budget},
+            };
+        }
+
+        std::ofstream file{ENGINE_DIR + engine::data_path + file_path};
+        if (not file)
+        {
+            std::cerr << RED_TEXT("[Memory Budget]\n") << ONE_TAB << "failed to write " << file_path << '\n';
+            return;
+        }
+        file << report.dump(4) << '\n';
+    }
+
+    void memory_budget::log(snapshot const &snapshot) const
+    {
+        std::cout << YELLOW_TEXT("[Memory Budget]\n");
+        for (size_t i = 0; i < snapshot.heaps.size(); ++i)
+        {
+            auto const &heap = snapshot.heaps[i];
+            std::cout << ONE_TAB << "heap " << i << (heap.device_local ? " device local: " : " host: ") << (heap.usage >> 20) << " of "
+                      << (heap.budget >> 20) << " MiB budget" << (snapshot.budget_extension ? "" : " (estimated)") << ", engine "
+                      << (heap.engine_bytes >> 20) << " MiB" << '\n';
+        }
+        for (size_t i = 0; i < category_count; ++i)
+        {
+            auto const &category = snapshot.categories[i];
+            if (category.allocations == 0)
+            {
+                continue;
+            }
+
+            std::cout << ONE_TAB << category_name(static_cast<memory_category>(i)) << ": " << category.allocations << " allocations, "
+                      << (category.bytes >> 10) << " KiB";
+            if (category.soft_budget > 0)
+            {
+                std::cout << " of " << (category.soft_budget >> 10) << " KiB";
+            }
+            std::cout << '\n';
+        }
+    }
+
+    auto memory_budget::category_name(memory_category category) -> char const *
+    {
+        switch (category)
+        {
+        case memory_category::mesh:    return "mesh";
+        case memory_category::texture: return "texture";
+        case memory_category::staging: return "staging";
+        case memory_category::uniform: return "uniform";
+        case memory_category::depth:   return "depth";
+        default:                       return "other";
+        }
+    }
+}
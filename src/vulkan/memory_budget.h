@@ -0,0 +1,99 @@
+﻿#pragma once
+
+// Project includes
+#include "src/vulkan/memory_allocator.h"
+
+// Standard includes
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Vulkan includes
+#include <vulkan/vulkan.h>
+
+namespace dae
+{
+    // How much memory the engine uses per category and heap, against the budget the driver reports through
+    // VK_EXT_memory_budget. Without the extension a heap's budget is estimated as a share of its size and its usage is
+    // what the allocator holds. Soft budgets per category are checked in update, their callback runs once every time
+    // the category crosses its budget, so it can drop streamed assets or caches before the device runs out.
+    class memory_budget final
+    {
+    public:
+        using callback = std::function<void(memory_category category, VkDeviceSize bytes, VkDeviceSize soft_budget)>;
+
+        static constexpr size_t category_count = static_cast<size_t>(memory_category::count);
+
+        struct heap_snapshot
+        {
+            VkDeviceSize size         = 0;
+            VkDeviceSize budget       = 0; // what the process can use before the driver starts paging
+            VkDeviceSize usage        = 0; // by the whole process, including memory the allocator does not know of
+            VkDeviceSize engine_bytes = 0; // held by the allocator
+            bool         device_local = false;
+        };
+
+        struct category_snapshot
+        {
+            VkDeviceSize bytes       = 0;
+            uint64_t     allocations = 0;
+            VkDeviceSize soft_budget = 0; // 0 when unlimited
+        };
+
+        struct snapshot
+        {
+            bool                                          budget_extension = false;
+            std::vector<heap_snapshot>                    heaps            = {};
+            std::array<category_snapshot, category_count> categories       = {};
+        };
+
+        // get_memory_properties_2 is nullptr unless VK_EXT_memory_budget is enabled
+        memory_budget(VkPhysicalDevice physical_device, PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_memory_properties_2, memory_allocator const &allocator);
+        ~memory_budget() = default;
+
+        memory_budget(memory_budget const &)            = delete;
+        memory_budget(memory_budget &&)                 = delete;
+        memory_budget &operator=(memory_budget const &) = delete;
+        memory_budget &operator=(memory_budget &&)      = delete;
+
+        [[nodiscard]] auto current() const -> snapshot;
+
+        // 0 removes the budget
+        void set_soft_budget(memory_category category, VkDeviceSize bytes, callback on_exceeded);
+
+        // Off until called, then every report_interval seconds the snapshot is written as JSON when a path is set and
+        // logged in debug builds
+        void set_report(float interval_seconds, std::string json_file_path = {});
+
+        // Once per frame, checks the soft budgets and reports when the interval elapsed
+        void update(float delta_time);
+
+        void write_json(snapshot const &snapshot, std::string const &file_path) const;
+        void log(snapshot const &snapshot) const;
+
+        static auto category_name(memory_category category) -> char const *;
+
+        // Heap budget assumed without the extension, the rest is left to other processes and the driver
+        static constexpr float estimated_budget_share = 0.8f;
+
+    private:
+        struct soft_budget
+        {
+            VkDeviceSize bytes       = 0;
+            callback     on_exceeded = {};
+            bool         exceeded    = false;
+        };
+
+        VkPhysicalDevice                             physical_device_         = VK_NULL_HANDLE;
+        PFN_vkGetPhysicalDeviceMemoryProperties2KHR  get_memory_properties_2_ = nullptr;
+        memory_allocator const                      *allocator_ptr_           = nullptr;
+
+        std::array<soft_budget, category_count> soft_budgets_ = {};
+
+        float       report_interval_  = 0.0f;
+        float       since_report_     = 0.0f;
+        std::string report_file_path_ = {};
+    };
+}
@@ -0,0 +1,140 @@
+﻿#include "staging_ring.h"
+
+// Project includes
+#include "src/vulkan/device.h"
+#include "src/vulkan/upload_batch.h"
+
+namespace dae
+{
+    staging_ring::staging_ring(VkDeviceSize capacity)
+        : device_ptr_{&device::instance()}
+        , buffer_{std::make_unique<buffer>(
+              capacity,
+              1,
+              VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+              1,
+              true)}
+        , capacity_{capacity}
+    {
+        // Mapped for its whole lifetime, coherent memory needs no flushes
+        buffer_->map();
+        mapped_ = static_cast<std::byte *>(buffer_->mapped_memory());
+        stats_.capacity = capacity_;
+    }
+
+    auto staging_ring::allocate(VkDeviceSize size, VkDeviceSize alignment) -> allocation
+    {
+        stats_.staged_bytes += size;
+
+        if (size <= capacity_)
+        {
+            // Uploads never straddle the end of the buffer, the skipped bytes go with the segment
+            uint64_t offset = (head_ + alignment - 1) / alignment * alignment;
+            bool const wraps = offset % capacity_ + size > capacity_;
+            if (wraps)
+            {
+                offset = (offset / capacity_ + 1) * capacity_;
+            }
+
+            auto const fits = [&] { return segments_.empty() or offset + size - segments_.front().begin <= capacity_; };
+
+            reclaim(false);
+            while (not fits() and reclaim(true))
+            {
+            }
+
+            if (fits())
+            {
+                upload_batch const *owner = upload_batch::active();
+                if (not segments_.empty() and segments_.back().owner == owner and segments_.back().fence == VK_NULL_HANDLE
+                    and not segments_.back().complete)
+                {
+                    segments_.back().end = offset + size;
+                }
+                else
+                {
+                    segments_.push_back({head_, offset + size, owner});
+                }
+
+                head_ = offset + size;
+                stats_.wraps += wraps ? 1 : 0;
+                ++stats_.ring_allocations;
+
+                VkDeviceSize const ring_offset = offset % capacity_;
+                return {buffer_->get_buffer(), ring_offset, mapped_ + ring_offset};
+            }
+        }
+
+        // Larger than the ring, or the ring is held by batches that did not submit yet
+        allocation result{};
+        result.dedicated = std::make_unique<buffer>(
+            size,
+            1,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            1,
+            true);
+        result.dedicated->map();
+        result.buffer = result.dedicated->get_buffer();
+        result.mapped = result.dedicated->mapped_memory();
+        ++stats_.dedicated_allocations;
+        return result;
+    }
+
+    void staging_ring::submitted(upload_batch const *batch, VkFence fence)
+    {
+        for (auto &pending : segments_)
+        {
+            if (pending.owner == batch and pending.fence == VK_NULL_HANDLE and not pending.complete)
+            {
+                pending.fence = fence;
+            }
+        }
+    }
+
+    void staging_ring::completed(upload_batch const *batch)
+    {
+        for (auto &pending : segments_)
+        {
+            if (pending.owner == batch)
+            {
+                pending.complete = true;
+            }
+        }
+        reclaim(false);
+    }
+
+    auto staging_ring::reclaim(bool wait) -> bool
+    {
+        bool reclaimed = false;
+        while (not segments_.empty())
+        {
+            segment &oldest = segments_.front();
+            if (not oldest.complete and oldest.fence != VK_NULL_HANDLE)
+            {
+                if (vkGetFenceStatus(device_ptr_->logical_device(), oldest.fence) == VK_SUCCESS)
+                {
+                    oldest.complete = true;
+                }
+                else if (wait)
+                {
+                    vkWaitForFences(device_ptr_->logical_device(), 1, &oldest.fence, VK_TRUE, UINT64_MAX);
+                    oldest.complete = true;
+                    wait            = false;
+                    ++stats_.fence_waits;
+                }
+            }
+
+            // A batch still recording holds everything behind it
+            if (not oldest.complete)
+            {
+                break;
+            }
+
+            segments_.pop_front();
+            reclaimed = true;
+        }
+        return reclaimed;
+    }
+}
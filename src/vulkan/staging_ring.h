@@ -0,0 +1,95 @@
+﻿#pragma once
+
+// Project includes
+#include "src/vulkan/buffer.h"
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+// Vulkan includes
+#include <vulkan/vulkan.h>
+
+namespace dae
+{
+    // Forward declarations
+    class device;
+    class upload_batch;
+
+    // One persistently mapped host buffer every upload stages through instead of allocating its own. Space is handed
+    // out front to back in segments, one per upload batch recording at the time, plus one for uploads submitted as
+    // single time commands. A segment is reclaimed once the submission that reads it completed, and a full ring waits
+    // on the oldest submission's fence. Uploads that can not fit, because they are larger than the ring or the ring is
+    // held by batches still recording, get a dedicated staging buffer instead.
+    class staging_ring final
+    {
+    public:
+        struct allocation
+        {
+            VkBuffer     buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            void        *mapped = nullptr;
+
+            // Owns the memory of a fallback allocation, hand it to upload_batch::retire once the copy is recorded
+            std::unique_ptr<dae::buffer> dedicated = {};
+        };
+
+        struct statistics
+        {
+            VkDeviceSize capacity              = 0;
+            uint64_t     ring_allocations      = 0;
+            uint64_t     dedicated_allocations = 0;
+            uint64_t     fence_waits           = 0; // allocations that had to wait for the GPU to free space
+            uint64_t     wraps                 = 0;
+            VkDeviceSize staged_bytes          = 0;
+        };
+
+        explicit staging_ring(VkDeviceSize capacity);
+        ~staging_ring() = default;
+
+        staging_ring(staging_ring const &)            = delete;
+        staging_ring(staging_ring &&)                 = delete;
+        staging_ring &operator=(staging_ring const &) = delete;
+        staging_ring &operator=(staging_ring &&)      = delete;
+
+        // Space for size bytes, read by the active upload batch or, without one, by the next single time commands
+        auto allocate(VkDeviceSize size, VkDeviceSize alignment = default_alignment) -> allocation;
+
+        // The batch's segments are read by the submission signalling fence
+        void submitted(upload_batch const *batch, VkFence fence);
+
+        // The batch's submission finished, or with nullptr the single time commands did
+        void completed(upload_batch const *batch);
+
+        [[nodiscard]] auto stats() const -> statistics { return stats_; }
+
+        // Covers the texel size of every format the engine uploads, and optimalBufferCopyOffsetAlignment in practice
+        static constexpr VkDeviceSize default_alignment = 16;
+        static constexpr VkDeviceSize default_capacity  = 64ull << 20;
+
+    private:
+        // [begin, end) in offsets that only grow, the ring position is the offset modulo the capacity
+        struct segment
+        {
+            uint64_t            begin    = 0;
+            uint64_t            end      = 0;
+            upload_batch const *owner    = nullptr;
+            VkFence             fence    = VK_NULL_HANDLE;
+            bool                complete = false;
+        };
+
+        // Drops completed segments from the front, waiting on the oldest fence when wait is set
+        auto reclaim(bool wait) -> bool;
+
+        device                 *device_ptr_ = nullptr;
+        std::unique_ptr<buffer> buffer_     = {};
+        std::byte              *mapped_     = nullptr;
+        VkDeviceSize            capacity_   = 0;
+        uint64_t                head_       = 0;
+
+        std::deque<segment> segments_ = {};
+        statistics          stats_    = {};
+    };
+}
@@ -49,7 +49,7 @@ namespace dae
         {
             vkDestroyImageView(device_ptr_->logical_device(), depth_image_views_[i], nullptr);
             vkDestroyImage(device_ptr_->logical_device(), depth_images_[i], nullptr);
-            vkFreeMemory(device_ptr_->logical_device(), depth_image_memories_[i], nullptr);
+            device_ptr_->memory().free(depth_image_allocations_[i]);
         }
 
         for (auto framebuffer : swap_chain_framebuffers_)
@@ -302,10 +302,10 @@ namespace dae
 
     void swap_chain::create_framebuffers()
     {
-        swap_chain_framebuffers_.resize(image_count());
-        for (size_t i = 0; i < image_count(); i++)
+        swap_chain_framebuffers_.resize(MAX_FRAMES_IN_FLIGHT * image_count());
+        for (size_t i = 0; i < swap_chain_framebuffers_.size(); i++)
         {
-            std::array<VkImageView, 2> attachments = {swap_chain_image_views_[i], depth_image_views_[i]};
+            std::array<VkImageView, 2> attachments = {swap_chain_image_views_[i % image_count()], depth_image_views_[i / image_count()]};
 
             VkExtent2D swap_chain_extent = this->swap_chain_extent();
             VkFramebufferCreateInfo framebuffer_info = {};
@@ -334,9 +334,9 @@ namespace dae
         swap_chain_depth_format_ = depth_format;
         VkExtent2D swap_chain_extent = this->swap_chain_extent();
 
-        depth_images_.resize(image_count());
-        depth_image_memories_.resize(image_count());
-        depth_image_views_.resize(image_count());
+        depth_images_.resize(MAX_FRAMES_IN_FLIGHT);
+        depth_image_allocations_.resize(MAX_FRAMES_IN_FLIGHT);
+        depth_image_views_.resize(MAX_FRAMES_IN_FLIGHT);
 
         for (int i = 0; i < depth_images_.size(); i++)
         {
@@ -351,16 +351,16 @@ namespace dae
             image_info.format        = depth_format;
             image_info.tiling        = VK_IMAGE_TILING_OPTIMAL;
             image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            image_info.usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            image_info.usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
             image_info.samples       = VK_SAMPLE_COUNT_1_BIT;
             image_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
             image_info.flags         = 0;
 
             device_ptr_->create_image_with_info(
                 image_info,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
                 depth_images_[i],
-                depth_image_memories_[i]);
+                depth_image_allocations_[i]);
 
             VkImageViewCreateInfo view_info{};
             view_info.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
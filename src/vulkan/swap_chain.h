@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+// Project includes
+#include "src/vulkan/memory_allocator.h"
+
 // Standard includes
 #include <memory>
 #include <vector>
@@ -25,7 +28,8 @@ namespace dae
         swap_chain &operator=(swap_chain const &) = delete;
         swap_chain &operator=(swap_chain &&)      = delete;
 
-        [[nodiscard]] auto get_frame_buffer(int index) const -> VkFramebuffer { return swap_chain_framebuffers_[index]; }
+        // Framebuffer of the acquired image, paired with the depth attachment of the frame being recorded
+        [[nodiscard]] auto get_frame_buffer(int index) const -> VkFramebuffer { return swap_chain_framebuffers_[current_frame_ * image_count() + index]; }
         [[nodiscard]] auto render_pass() const -> VkRenderPass { return render_pass_; }
         [[nodiscard]] auto get_image_view(int index) const -> VkImageView { return swap_chain_image_views_[index]; }
         [[nodiscard]] auto image_count() const -> size_t { return swap_chain_images_.size(); }
@@ -64,14 +68,17 @@ namespace dae
         VkFormat   swap_chain_depth_format_ = VK_FORMAT_UNDEFINED;
         VkExtent2D swap_chain_extent_       = {};
 
+        // One per frame in flight and swap chain image, frame major
         std::vector<VkFramebuffer> swap_chain_framebuffers_ = {};
         VkRenderPass               render_pass_             = VK_NULL_HANDLE;
 
-        std::vector<VkImage>        depth_images_           = {};
-        std::vector<VkDeviceMemory> depth_image_memories_   = {};
-        std::vector<VkImageView>    depth_image_views_      = {};
-        std::vector<VkImage>        swap_chain_images_      = {};
-        std::vector<VkImageView>    swap_chain_image_views_ = {};
+        // Depth is cleared on load and never stored, so only the frames in flight need one, not every swap chain image.
+        // Transient and lazily allocated where the device can, a tiler then keeps depth in tile memory only.
+        std::vector<VkImage>                      depth_images_            = {};
+        std::vector<memory_allocator::allocation> depth_image_allocations_ = {};
+        std::vector<VkImageView>                  depth_image_views_       = {};
+        std::vector<VkImage>                      swap_chain_images_       = {};
+        std::vector<VkImageView>                  swap_chain_image_views_  = {};
 
         device     *device_ptr_   = nullptr;
         VkExtent2D window_extent_ = {};
@@ -0,0 +1,224 @@
+﻿#include "upload_batch.h"
+
+// Project includes
+#include "src/vulkan/device.h"
+
+// Standard includes
+#include <stdexcept>
+
+namespace dae
+{
+    thread_local upload_batch *upload_batch::active_ = nullptr;
+
+    upload_batch::upload_batch()
+        : device_ptr_{&device::instance()}
+    {
+        graphics_command_buffer_ = create_command_buffer(device_ptr_->graphics_family(), graphics_pool_);
+        transfer_command_buffer_ = graphics_command_buffer_;
+
+        if (device_ptr_->has_transfer_queue())
+        {
+            transfer_command_buffer_ = create_command_buffer(device_ptr_->transfer_family(), transfer_pool_);
+
+            VkSemaphoreCreateInfo semaphore_info{};
+            semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+            if (vkCreateSemaphore(device_ptr_->logical_device(), &semaphore_info, nullptr, &transfer_semaphore_) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create upload semaphore!");
+            }
+        }
+
+        VkFenceCreateInfo fence_info{};
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkCreateFence(device_ptr_->logical_device(), &fence_info, nullptr, &fence_) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create upload fence!");
+        }
+
+        previous_ = active_;
+        active_   = this;
+    }
+
+    upload_batch::~upload_batch()
+    {
+        if (not submitted_)
+        {
+            submit();
+        }
+        wait();
+
+        vkDestroyFence(device_ptr_->logical_device(), fence_, nullptr);
+        if (transfer_semaphore_ != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(device_ptr_->logical_device(), transfer_semaphore_, nullptr);
+        }
+        if (transfer_pool_ != VK_NULL_HANDLE)
+        {
+            vkDestroyCommandPool(device_ptr_->logical_device(), transfer_pool_, nullptr);
+        }
+        vkDestroyCommandPool(device_ptr_->logical_device(), graphics_pool_, nullptr);
+    }
+
+    auto upload_batch::active() -> upload_batch *
+    {
+        return active_;
+    }
+
+    void upload_batch::retire(std::unique_ptr<buffer> buffer)
+    {
+        if (active_ != nullptr)
+        {
+            active_->retired_buffers_.push_back(std::move(buffer));
+        }
+    }
+
+    void upload_batch::release_image(VkImage image, VkImageSubresourceRange const &range, VkImageLayout layout)
+    {
+        if (not uses_transfer_queue())
+        {
+            return;
+        }
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout           = layout;
+        barrier.newLayout           = layout;
+        barrier.srcQueueFamilyIndex = device_ptr_->transfer_family();
+        barrier.dstQueueFamilyIndex = device_ptr_->graphics_family();
+        barrier.image               = image;
+        barrier.subresourceRange    = range;
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(transfer_command_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(
+            graphics_command_buffer_,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            &barrier);
+    }
+
+    void upload_batch::submit()
+    {
+        if (submitted_)
+        {
+            return;
+        }
+        submitted_ = true;
+
+        if (active_ == this)
+        {
+            active_ = previous_;
+        }
+
+        // Copies are read by later frames on the graphics queue, make them visible to vertex fetch and shaders
+        VkMemoryBarrier barrier{};
+        barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            graphics_command_buffer_,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            1,
+            &barrier,
+            0,
+            nullptr,
+            0,
+            nullptr);
+
+        VkSubmitInfo graphics_submit{};
+        graphics_submit.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        graphics_submit.commandBufferCount = 1;
+        graphics_submit.pCommandBuffers    = &graphics_command_buffer_;
+
+        VkPipelineStageFlags const wait_stage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        if (uses_transfer_queue())
+        {
+            vkEndCommandBuffer(transfer_command_buffer_);
+
+            VkSubmitInfo transfer_submit{};
+            transfer_submit.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            transfer_submit.commandBufferCount   = 1;
+            transfer_submit.pCommandBuffers      = &transfer_command_buffer_;
+            transfer_submit.signalSemaphoreCount = 1;
+            transfer_submit.pSignalSemaphores    = &transfer_semaphore_;
+
+            if (vkQueueSubmit(device_ptr_->transfer_queue(), 1, &transfer_submit, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to submit upload batch to the transfer queue!");
+            }
+
+            graphics_submit.waitSemaphoreCount = 1;
+            graphics_submit.pWaitSemaphores    = &transfer_semaphore_;
+            graphics_submit.pWaitDstStageMask  = &wait_stage;
+        }
+
+        vkEndCommandBuffer(graphics_command_buffer_);
+
+        if (vkQueueSubmit(device_ptr_->graphics_queue(), 1, &graphics_submit, fence_) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to submit upload batch!");
+        }
+        device_ptr_->staging().submitted(this, fence_);
+    }
+
+    auto upload_batch::is_complete() const -> bool
+    {
+        return submitted_ and vkGetFenceStatus(device_ptr_->logical_device(), fence_) == VK_SUCCESS;
+    }
+
+    void upload_batch::wait()
+    {
+        if (not submitted_)
+        {
+            return;
+        }
+
+        vkWaitForFences(device_ptr_->logical_device(), 1, &fence_, VK_TRUE, UINT64_MAX);
+        device_ptr_->staging().completed(this);
+        retired_buffers_.clear();
+    }
+
+    auto upload_batch::create_command_buffer(uint32_t queue_family, VkCommandPool &pool) -> VkCommandBuffer
+    {
+        VkCommandPoolCreateInfo pool_info{};
+        pool_info.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.queueFamilyIndex = queue_family;
+        pool_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        if (vkCreateCommandPool(device_ptr_->logical_device(), &pool_info, nullptr, &pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandPool        = pool;
+        alloc_info.commandBufferCount = 1;
+
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        vkAllocateCommandBuffers(device_ptr_->logical_device(), &alloc_info, &command_buffer);
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(command_buffer, &begin_info);
+        return command_buffer;
+    }
+}
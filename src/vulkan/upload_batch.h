@@ -0,0 +1,90 @@
+﻿#pragma once
+
+// Project includes
+#include "src/vulkan/buffer.h"
+
+// Standard includes
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Vulkan includes
+#include <vulkan/vulkan.h>
+
+namespace dae
+{
+    // Forward declarations
+    class device;
+
+    // Records every upload made while it is active and submits them together behind a fence. While a batch is active on
+    // the calling thread, device::begin_single_time_commands hands out its copy command buffer and
+    // device::end_single_time_commands no longer drains the queue, so the copies recorded by the geometry arena and
+    // textures all land in one submission.
+    //
+    // With a separate transfer family the copies run on the transfer queue. Work that needs the graphics queue, such as
+    // mip blits, goes into a second command buffer that waits on a semaphore, and images written by the copies change
+    // queue family ownership through release_image. Buffers the copies write are created with concurrent sharing
+    // instead, see geometry_arena. Without a transfer family both command buffers are the same and everything is
+    // submitted to the graphics queue.
+    class upload_batch final
+    {
+    public:
+        upload_batch();
+        ~upload_batch(); // submits and waits if the batch is still recording
+
+        upload_batch(upload_batch const &)            = delete;
+        upload_batch(upload_batch &&)                 = delete;
+        upload_batch &operator=(upload_batch const &) = delete;
+        upload_batch &operator=(upload_batch &&)      = delete;
+
+        // The batch recording on this thread, nullptr outside of one
+        [[nodiscard]] static auto active() -> upload_batch *;
+
+        // Keeps a buffer alive until the active batch completed, destroys it right away when no batch is active
+        static void retire(std::unique_ptr<buffer> buffer);
+
+        // Copies, executed on the transfer queue when there is one
+        [[nodiscard]] auto command_buffer() const -> VkCommandBuffer { return transfer_command_buffer_; }
+
+        // Executed on the graphics queue after every copy in the batch
+        [[nodiscard]] auto graphics_command_buffer() const -> VkCommandBuffer { return graphics_command_buffer_; }
+
+        [[nodiscard]] auto recorded_commands() const -> uint32_t { return recorded_commands_; }
+        [[nodiscard]] auto uses_transfer_queue() const -> bool { return transfer_command_buffer_ != graphics_command_buffer_; }
+
+        // Counts one begin/end_single_time_commands pair recorded into this batch
+        void note_recorded() { ++recorded_commands_; }
+
+        // Hands an image written by the copies to the graphics family, keeping its layout
+        void release_image(VkImage image, VkImageSubresourceRange const &range, VkImageLayout layout);
+
+        // Ends recording and submits once, later uploads on this thread go back to single time commands
+        void submit();
+
+        // Polls the fence, false while the batch is recording or executing
+        [[nodiscard]] auto is_complete() const -> bool;
+
+        // Blocks until the submission finished, then releases the retired buffers and its staging ring space
+        void wait();
+
+    private:
+        auto create_command_buffer(uint32_t queue_family, VkCommandPool &pool) -> VkCommandBuffer;
+
+        device *device_ptr_ = nullptr;
+
+        VkCommandPool   transfer_pool_           = VK_NULL_HANDLE;
+        VkCommandPool   graphics_pool_           = VK_NULL_HANDLE;
+        VkCommandBuffer transfer_command_buffer_ = VK_NULL_HANDLE;
+        VkCommandBuffer graphics_command_buffer_ = VK_NULL_HANDLE;
+        VkSemaphore     transfer_semaphore_      = VK_NULL_HANDLE;
+        VkFence         fence_                   = VK_NULL_HANDLE;
+
+        std::vector<std::unique_ptr<buffer>> retired_buffers_ = {};
+
+        upload_batch *previous_          = nullptr;
+        uint32_t      recorded_commands_ = 0;
+        bool          submitted_         = false;
+
+        static thread_local upload_batch *active_;
+    };
+}
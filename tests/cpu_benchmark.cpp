@@ -0,0 +1,271 @@
+﻿// CPU side benchmarks of the scene and model code, each against the path it replaced. Runs every section, or the ones
+// named as arguments:
+//     transforms [count]  cached transforms updated by component_store against matrices evaluated every frame
+//     dedup [grid_size]   vertex_dedup_table against the std::unordered_map it replaced
+
+// Project includes
+#include "src/core/component_store.h"
+#include "src/core/model.h"
+#include "src/core/vertex_dedup_table.h"
+#include "src/utility/frame_arena.h"
+#include "src/utility/utils.h"
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// GLM includes
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+namespace
+{
+    using namespace dae;
+
+    // Keeps the measured work from being optimised away
+    volatile float sink = 0.0f;
+
+    template <typename task_t>
+    auto time_ms(task_t const &task) -> double
+    {
+        auto const start = std::chrono::steady_clock::now();
+        task();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // transform_component::mat4 and normal_matrix before the matrices were cached, six sin and cos each
+    auto uncached_world_matrix(glm::vec3 const &translation, glm::vec3 const &rotation, glm::vec3 const &scale) -> glm::mat4
+    {
+        float const c3 = glm::cos(rotation.z);
+        float const s3 = glm::sin(rotation.z);
+        float const c2 = glm::cos(rotation.x);
+        float const s2 = glm::sin(rotation.x);
+        float const c1 = glm::cos(rotation.y);
+        float const s1 = glm::sin(rotation.y);
+        return glm::mat4{
+            {scale.x * (c1 * c3 + s1 * s2 * s3), scale.x * (c2 * s3), scale.x * (c1 * s2 * s3 - c3 * s1), 0.0f},
+            {scale.y * (c3 * s1 * s2 - c1 * s3), scale.y * (c2 * c3), scale.y * (c1 * c3 * s2 + s1 * s3), 0.0f},
+            {scale.z * (c2 * s1), scale.z * (-s2), scale.z * (c1 * c2), 0.0f},
+            {translation.x, translation.y, translation.z, 1.0f}};
+    }
+
+    auto uncached_normal_matrix(glm::vec3 const &rotation, glm::vec3 const &scale) -> glm::mat4
+    {
+        float const c3 = glm::cos(rotation.z);
+        float const s3 = glm::sin(rotation.z);
+        float const c2 = glm::cos(rotation.x);
+        float const s2 = glm::sin(rotation.x);
+        float const c1 = glm::cos(rotation.y);
+        float const s1 = glm::sin(rotation.y);
+        glm::vec3 const inverse_scale = 1.0f / scale;
+        return glm::mat3{
+            {inverse_scale.x * (c1 * c3 + s1 * s2 * s3), inverse_scale.x * (c2 * s3), inverse_scale.x * (c1 * s2 * s3 - c3 * s1)},
+            {inverse_scale.y * (c3 * s1 * s2 - c1 * s3), inverse_scale.y * (c2 * c3), inverse_scale.y * (c1 * c3 * s2 + s1 * s3)},
+            {inverse_scale.z * (c2 * s1), inverse_scale.z * (-s2), inverse_scale.z * (c1 * c2)}};
+    }
+
+    // A frame moves a share of the objects, then every object's world and normal matrix is copied out like the systems
+    // copy them into the frame allocator
+    void benchmark_transforms(size_t count)
+    {
+        constexpr int frames = 100;
+
+        std::mt19937 random{22};
+        std::uniform_real_distribution<float> distribution{-10.0f, 10.0f};
+
+        component_store store{};
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto &transform = store.transforms().emplace(store.create());
+            transform.set_translation({distribution(random), distribution(random), distribution(random)});
+            transform.set_rotation({distribution(random), distribution(random), distribution(random)});
+            transform.set_scale(glm::vec3{1.0f + std::abs(distribution(random))});
+        }
+        frame_arena::instance().reset();
+        store.update_transforms();
+
+        std::vector<glm::mat4> object_data(count * 2);
+
+        std::cout << "transforms, " << count << " objects, average of " << frames << " frames\n";
+        for (double const moving_share : {0.0, 0.01, 0.1, 1.0})
+        {
+            auto transforms = store.transforms().components();
+            auto const moving = static_cast<size_t>(static_cast<double>(count) * moving_share);
+
+            auto const move = [&](int frame)
+            {
+                for (size_t i = 0; i < moving; ++i)
+                {
+                    transforms[i].set_rotation(transforms[i].rotation() + glm::vec3{0.001f * static_cast<float>(frame)});
+                }
+            };
+
+            double uncached = 0.0;
+            double cached   = 0.0;
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                frame_arena::instance().reset();
+                move(frame);
+                uncached += time_ms([&]
+                {
+                    for (size_t i = 0; i < transforms.size(); ++i)
+                    {
+                        object_data[i * 2 + 0] = uncached_world_matrix(transforms[i].translation(), transforms[i].rotation(), transforms[i].scale());
+                        object_data[i * 2 + 1] = uncached_normal_matrix(transforms[i].rotation(), transforms[i].scale());
+                    }
+                });
+                sink = object_data[frame % object_data.size()][frame % 4][frame % 3];
+
+                // The same frame again, with the cached matrices this time
+                store.update_transforms();
+                frame_arena::instance().reset();
+                move(frame);
+                cached += time_ms([&]
+                {
+                    store.update_transforms();
+                    for (size_t i = 0; i < transforms.size(); ++i)
+                    {
+                        object_data[i * 2 + 0] = transforms[i].mat4();
+                        object_data[i * 2 + 1] = transforms[i].normal_matrix();
+                    }
+                });
+                sink = object_data[frame % object_data.size()][frame % 4][frame % 3];
+            }
+
+            std::cout << '\t' << moving_share * 100.0 << "% moving: every frame " << uncached / frames << " ms, cached "
+                      << cached / frames << " ms, " << uncached / cached << "x\n";
+        }
+    }
+
+    // std::hash<model::vertex> before vertex_dedup_table replaced the map
+    struct vertex_hash
+    {
+        auto operator()(model::vertex const &vertex) const noexcept -> size_t
+        {
+            size_t seed = 0;
+            hash_combine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+            return seed;
+        }
+    };
+
+    // Corners of a grid_size^2 quad grid as an OBJ hands them over, every vertex shared by up to six corners
+    void benchmark_dedup(int grid_size)
+    {
+        constexpr int runs = 5;
+
+        constexpr std::array<std::pair<int, int>, 6> quad_corners{{{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}}};
+
+        std::vector<model::vertex> corners{};
+        corners.reserve(static_cast<size_t>(grid_size) * grid_size * 6);
+        auto const vertex_at = [grid_size](int x, int y)
+        {
+            model::vertex vertex{};
+            vertex.position = {static_cast<float>(x), static_cast<float>(y), static_cast<float>((x * y) % 7)};
+            vertex.color    = {1.0f, 1.0f, 1.0f};
+            vertex.normal   = glm::normalize(glm::vec3{static_cast<float>(x % 5), static_cast<float>(y % 3), 1.0f});
+            vertex.uv       = {static_cast<float>(x) / static_cast<float>(grid_size), static_cast<float>(y) / static_cast<float>(grid_size)};
+            return vertex;
+        };
+        for (int y = 0; y < grid_size; ++y)
+        {
+            for (int x = 0; x < grid_size; ++x)
+            {
+                for (auto const &[dx, dy] : quad_corners)
+                {
+                    corners.push_back(vertex_at(x + dx, y + dy));
+                }
+            }
+        }
+
+        std::vector<model::vertex> vertices{};
+        std::vector<uint32_t>      indices{};
+
+        auto const best = [&](auto const &task)
+        {
+            double best_time = 1e30;
+            for (int run = 0; run < runs; ++run)
+            {
+                vertices.clear();
+                indices.clear();
+                best_time = std::min(best_time, time_ms(task));
+            }
+            return best_time;
+        };
+
+        // What load_model did before, a contains lookup followed by operator[] for new and for every corner
+        double const map_time = best([&]
+        {
+            std::unordered_map<model::vertex, uint32_t, vertex_hash> unique_vertices{};
+            for (auto const &vertex : corners)
+            {
+                if (not unique_vertices.contains(vertex))
+                {
+                    unique_vertices[vertex] = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(vertex);
+                }
+                indices.push_back(unique_vertices[vertex]);
+            }
+        });
+        size_t const map_vertices = vertices.size();
+
+        auto const table_time = [&](float weld_epsilon)
+        {
+            return best([&]
+            {
+                vertex_dedup_table unique_vertices{vertices, corners.size(), weld_epsilon};
+                for (auto const &vertex : corners)
+                {
+                    auto const new_index   = static_cast<uint32_t>(vertices.size());
+                    auto const found_index = unique_vertices.find_or_insert(vertex, new_index);
+                    if (found_index == new_index)
+                    {
+                        vertices.push_back(vertex);
+                    }
+                    indices.push_back(found_index);
+                }
+            });
+        };
+        double const exact_time = table_time(0.0f);
+        size_t const table_vertices = vertices.size();
+        double const weld_time = table_time(1e-4f);
+
+        std::cout << "dedup, " << corners.size() << " corners, " << map_vertices << " unique, best of " << runs << " runs\n"
+                  << "\tunordered_map      " << map_time << " ms\n"
+                  << "\tvertex_dedup_table " << exact_time << " ms, " << map_time / exact_time << "x"
+                  << (table_vertices == map_vertices ? "\n" : ", different vertex count\n")
+                  << "\twelding at 1e-4    " << weld_time << " ms\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> const arguments(argv + 1, argv + argc);
+    auto const selected = [&](std::string const &section) { return arguments.empty() or std::ranges::find(arguments, section) != arguments.end(); };
+    auto const parameter = [&](std::string const &section, size_t default_value) -> size_t
+    {
+        auto const found = std::ranges::find(arguments, section);
+        return found != arguments.end() and found + 1 != arguments.end() and std::isdigit(static_cast<unsigned char>((*(found + 1))[0]))
+            ? std::stoul(*(found + 1))
+            : default_value;
+    };
+
+    if (selected("transforms"))
+    {
+        benchmark_transforms(parameter("transforms", 100000));
+    }
+    if (selected("dedup"))
+    {
+        benchmark_dedup(static_cast<int>(parameter("dedup", 1000)));
+    }
+    return EXIT_SUCCESS;
+}
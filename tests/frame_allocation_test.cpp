@@ -0,0 +1,139 @@
+﻿// Runs the engine's frame loop over the shipped scenes and systems and fails when the steady state frames allocate
+// from the heap. Counts every operator new on the main thread, the one the frame loop and the frame arena run on.
+
+// Project includes
+#include "src/engine/engine.h"
+#include "src/engine/scene_config_manager.h"
+#include "src/engine/scene_loader.h"
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <new>
+
+namespace
+{
+    // Frames the arena, the frame allocator and the lazily created pipelines get to settle in
+    constexpr uint64_t warm_up_frames = 100;
+    constexpr uint64_t tested_frames  = 1000;
+
+    // ctest reports the test as skipped, see SKIP_RETURN_CODE in tests/CMakeLists.txt
+    constexpr int skip_return_code = 77;
+
+    std::atomic<uint64_t> allocation_count = 0;
+    thread_local bool     counted_thread   = false;
+
+    auto counted_allocate(std::size_t size) -> void *
+    {
+        if (counted_thread)
+        {
+            allocation_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (void *data = std::malloc(size == 0 ? 1 : size))
+        {
+            return data;
+        }
+        throw std::bad_alloc{};
+    }
+
+    auto counted_allocate(std::size_t size, std::align_val_t alignment) -> void *
+    {
+        if (counted_thread)
+        {
+            allocation_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // aligned_alloc wants the size to be a multiple of the alignment
+        auto const align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+        void *data = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+        void *data = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align);
+#endif
+        if (data)
+        {
+            return data;
+        }
+        throw std::bad_alloc{};
+    }
+
+    void aligned_free(void *data)
+    {
+#if defined(_MSC_VER)
+        _aligned_free(data);
+#else
+        std::free(data);
+#endif
+    }
+
+    void load()
+    {
+        dae::scene_config_manager::instance().load_scene_config("configs/scene_config.json");
+        dae::scene_loader::instance().load_scenes();
+    }
+}
+
+auto operator new(std::size_t size) -> void * { return counted_allocate(size); }
+auto operator new[](std::size_t size) -> void * { return counted_allocate(size); }
+auto operator new(std::size_t size, std::align_val_t alignment) -> void * { return counted_allocate(size, alignment); }
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void * { return counted_allocate(size, alignment); }
+
+void operator delete(void *data) noexcept { std::free(data); }
+void operator delete[](void *data) noexcept { std::free(data); }
+void operator delete(void *data, std::size_t) noexcept { std::free(data); }
+void operator delete[](void *data, std::size_t) noexcept { std::free(data); }
+void operator delete(void *data, std::align_val_t) noexcept { aligned_free(data); }
+void operator delete[](void *data, std::align_val_t) noexcept { aligned_free(data); }
+void operator delete(void *data, std::size_t, std::align_val_t) noexcept { aligned_free(data); }
+void operator delete[](void *data, std::size_t, std::align_val_t) noexcept { aligned_free(data); }
+
+int main()
+{
+    counted_thread = true;
+
+    // Without a window or a Vulkan device there is nothing to test
+    std::unique_ptr<dae::engine> engine{};
+    try
+    {
+        engine = std::make_unique<dae::engine>("data/");
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "skipped, the engine could not start: " << e.what() << '\n';
+        return skip_return_code;
+    }
+
+    uint64_t warm_up_allocations = 0;
+    uint64_t frames              = 0;
+    engine->run(load, [&](uint64_t frame_count)
+    {
+        if (frame_count == warm_up_frames)
+        {
+            warm_up_allocations = allocation_count.exchange(0);
+        }
+        frames = frame_count;
+        return frame_count < warm_up_frames + tested_frames;
+    });
+
+    uint64_t const allocations = allocation_count.load();
+    if (frames < warm_up_frames + tested_frames)
+    {
+        std::cerr << "the window closed after " << frames << " frames\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << warm_up_allocations << " heap allocations during " << warm_up_frames << " warm up frames, " << allocations
+              << " during the next " << tested_frames << '\n';
+    if (allocations != 0)
+    {
+        std::cerr << "the steady state frame loop allocated from the heap\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
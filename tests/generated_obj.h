@@ -0,0 +1,72 @@
+﻿#pragma once
+
+// Standard includes
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace dae
+{
+    // Four grids of grid_size^2 quads, some split into triangles, in every corner form with absolute and relative
+    // indices mixed and some vertices colored. At 160 the file is large enough to split into 8 chunks.
+    inline void write_generated_obj(std::string const &file_path, int grid_size, char const *newline = "\n")
+    {
+        std::ofstream output{file_path, std::ios::binary};
+        std::mt19937 random{7};
+        std::uniform_real_distribution<float> coordinate{-100.0f, 100.0f};
+
+        int vertex_count = 0;
+        for (int block = 0; block < 4; ++block)
+        {
+            output << "o block" << block << newline;
+            int const first_vertex = vertex_count;
+            for (int y = 0; y <= grid_size; ++y)
+            {
+                for (int x = 0; x <= grid_size; ++x)
+                {
+                    output << "v " << x + coordinate(random) * 1e-3f << ' ' << y << ' ' << coordinate(random);
+                    if ((x + y) % 5 == 0)
+                    {
+                        output << ' ' << (x % 7) / 7.0f << ' ' << (y % 3) / 3.0f << " 0.5";
+                    }
+                    output << newline << "vt " << x / float(grid_size) << ' ' << y / float(grid_size) << newline
+                           << "vn " << coordinate(random) << ' ' << coordinate(random) << " 1" << newline;
+                    ++vertex_count;
+                }
+            }
+
+            for (int y = 0; y < grid_size; ++y)
+            {
+                for (int x = 0; x < grid_size; ++x)
+                {
+                    int const corners[4] = {
+                        first_vertex + y * (grid_size + 1) + x + 1,
+                        first_vertex + y * (grid_size + 1) + x + 2,
+                        first_vertex + (y + 1) * (grid_size + 1) + x + 2,
+                        first_vertex + (y + 1) * (grid_size + 1) + x + 1};
+                    auto const corner = [&](int i)
+                    {
+                        int const index = (x + block) % 3 == 0 ? corners[i] - vertex_count - 1 : corners[i];
+                        switch ((x + y) % 4)
+                        {
+                        case 0: return std::to_string(index) + '/' + std::to_string(index) + '/' + std::to_string(index);
+                        case 1: return std::to_string(index) + "//" + std::to_string(index);
+                        case 2: return std::to_string(index) + '/' + std::to_string(index);
+                        default: return std::to_string(index);
+                        }
+                    };
+
+                    if (y % 4 == 3)
+                    {
+                        output << "f " << corner(0) << ' ' << corner(1) << ' ' << corner(2) << newline
+                               << "f " << corner(0) << ' ' << corner(2) << ' ' << corner(3) << newline;
+                    }
+                    else
+                    {
+                        output << "f " << corner(0) << ' ' << corner(1) << ' ' << corner(2) << ' ' << corner(3) << newline;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+﻿// Times every model in data/assets/models, or the ones given as paths relative to data/, loaded cold from the OBJ
+// against loaded warm from its .mesh cache. Loads through ENGINE_DIR like the engine, so run it from the same folder.
+// Cold loads delete the cache first and write it again, the models are left cached afterwards.
+
+// Project includes
+#include "src/core/mesh_cache.h"
+#include "src/core/model.h"
+#include "src/engine/engine.h"
+
+// Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(CMAKE_BUILD)
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../../../"
+#endif
+#else
+#ifndef ENGINE_DIR
+#define ENGINE_DIR ""
+#endif
+#endif
+
+namespace
+{
+    using namespace dae;
+
+    constexpr int runs = 3;
+
+    // Best of runs, in milliseconds, prepare is not timed
+    template <typename prepare_t, typename task_t>
+    auto best_time(prepare_t const &prepare, task_t const &task) -> double
+    {
+        double best = 1e30;
+        for (int run = 0; run < runs; ++run)
+        {
+            prepare();
+            auto const start = std::chrono::steady_clock::now();
+            task();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    void benchmark(std::string const &file_path)
+    {
+        std::string const source_path = ENGINE_DIR + engine::data_path + file_path;
+        std::string const cache_path  = mesh_cache::cache_path(source_path);
+
+        size_t vertex_count = 0;
+        size_t index_count  = 0;
+
+        // Parse, dedup, tangents, LODs, optimization, meshlets and writing the cache
+        double const cold_time = best_time([&] { std::filesystem::remove(cache_path); }, [&]
+        {
+            auto const builder = model::load_builder(file_path);
+            vertex_count = builder.vertices.size();
+            index_count  = builder.indices.size();
+        });
+
+        // What streaming does, copying the arrays out of the mapped cache
+        double const warm_time = best_time([] {}, [&] { auto const builder = model::load_builder(file_path); });
+
+        // What create_model does before uploading straight from the mapping
+        double const mapped_time = best_time([] {}, [&]
+        {
+            if (not mesh_cache::open(source_path, model::builder{}))
+            {
+                std::cerr << cache_path << " was not written\n";
+                std::exit(EXIT_FAILURE);
+            }
+        });
+
+        double const mib = static_cast<double>(std::filesystem::file_size(source_path)) / (1 << 20);
+        std::cout << file_path << ", " << mib << " MiB, " << vertex_count << " vertices, " << index_count << " indices\n"
+                  << "\tcold   " << cold_time << " ms\n"
+                  << "\twarm   " << warm_time << " ms, " << cold_time / warm_time << "x\n"
+                  << "\tmapped " << mapped_time << " ms, " << cold_time / mapped_time << "x\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    engine::data_path = "data/";
+
+    std::vector<std::string> file_paths(argv + 1, argv + argc);
+    if (file_paths.empty())
+    {
+        std::filesystem::path const models_path{ENGINE_DIR + engine::data_path + "assets/models"};
+        if (not std::filesystem::is_directory(models_path))
+        {
+            std::cerr << models_path.string() << " does not exist, run from the engine's working folder or pass models\n";
+            return EXIT_FAILURE;
+        }
+        for (auto const &entry : std::filesystem::directory_iterator{models_path})
+        {
+            if (entry.path().extension() == ".obj")
+            {
+                file_paths.push_back("assets/models/" + entry.path().filename().string());
+            }
+        }
+        std::ranges::sort(file_paths);
+    }
+
+    for (auto const &file_path : file_paths)
+    {
+        benchmark(file_path);
+    }
+    return EXIT_SUCCESS;
+}
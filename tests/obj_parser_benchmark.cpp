@@ -0,0 +1,102 @@
+﻿// Times tinyobj::LoadObj against obj_parser::parse at powers of two threads and at all hardware threads. Takes OBJ paths as
+// arguments, without any it generates one of about 150 MiB in the temp folder.
+
+// Project includes
+#include "src/core/obj_parser.h"
+#include "tests/generated_obj.h"
+
+// Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// tinyobj includes
+#include <tiny_obj_loader.h>
+
+namespace
+{
+    constexpr int runs = 3;
+
+    // Best of runs, in milliseconds
+    template <typename task_t>
+    auto best_time(task_t const &task) -> double
+    {
+        double best = 1e30;
+        for (int run = 0; run < runs; ++run)
+        {
+            auto const start = std::chrono::steady_clock::now();
+            task();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    void benchmark(std::string const &file_path)
+    {
+        double const mib = static_cast<double>(std::filesystem::file_size(file_path)) / (1 << 20);
+        std::cout << file_path << ", " << mib << " MiB\n";
+
+        double const tinyobj_time = best_time([&]
+        {
+            tinyobj::attrib_t                attrib;
+            std::vector<tinyobj::shape_t>    shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string                      warn, err;
+            if (not tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file_path.c_str()))
+            {
+                std::cerr << warn << err << '\n';
+                std::exit(EXIT_FAILURE);
+            }
+        });
+        std::cout << "\ttinyobj          " << tinyobj_time << " ms, " << mib / tinyobj_time * 1000.0 << " MiB/s\n";
+
+        uint32_t const        hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<uint32_t> thread_counts{};
+        for (uint32_t thread_count = 1; thread_count < hardware_threads; thread_count *= 2)
+        {
+            thread_counts.push_back(thread_count);
+        }
+        thread_counts.push_back(hardware_threads);
+
+        for (uint32_t const thread_count : thread_counts)
+        {
+            bool parsed = true;
+            double const parser_time = best_time([&]
+            {
+                dae::obj_parser::result result{};
+                parsed = dae::obj_parser::parse(file_path, result, thread_count);
+            });
+            if (not parsed)
+            {
+                std::cout << "\tobj_parser leaves polygons to tinyobj\n";
+                return;
+            }
+            std::cout << "\tobj_parser x " << thread_count << (thread_count < 10 ? "  " : " ") << parser_time << " ms, "
+                      << mib / parser_time * 1000.0 << " MiB/s, " << tinyobj_time / parser_time << "x\n";
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            benchmark(argv[i]);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    std::string const generated = (std::filesystem::temp_directory_path() / "obj_parser_benchmark.obj").string();
+    dae::write_generated_obj(generated, 500);
+    benchmark(generated);
+    std::filesystem::remove(generated);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+﻿// Parses the fixtures in tests/data/obj, and larger generated files split over several chunks, with obj_parser and
+// with tinyobj, and checks that both produce the same attributes, corners and deduplicated builder arrays.
+
+// Project includes
+#include "src/core/model.h"
+#include "src/core/obj_parser.h"
+#include "src/core/vertex_dedup_table.h"
+#include "tests/generated_obj.h"
+
+// Standard includes
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// tinyobj includes
+#include <tiny_obj_loader.h>
+
+namespace
+{
+    using namespace dae;
+
+    struct builder_arrays
+    {
+        std::vector<model::vertex> vertices = {};
+        std::vector<uint32_t>      indices  = {};
+    };
+
+    int failures = 0;
+
+    void expect(bool condition, std::string const &file_path, char const *what)
+    {
+        if (not condition)
+        {
+            std::cerr << file_path << ": " << what << '\n';
+            ++failures;
+        }
+    }
+
+    // The corner assembly of model::builder::load_model, shared by both of its paths
+    template <typename attributes_t, typename corners_t>
+    void append_corners(builder_arrays &builder, vertex_dedup_table &unique_vertices, attributes_t const &attrib, corners_t const &corners)
+    {
+        for (auto const &index : corners)
+        {
+            model::vertex vertex{};
+            if (index.vertex_index >= 0)
+            {
+                vertex.position = {attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2]};
+                vertex.color    = {attrib.colors[3 * index.vertex_index + 0], attrib.colors[3 * index.vertex_index + 1], attrib.colors[3 * index.vertex_index + 2]};
+            }
+            if (index.normal_index >= 0)
+            {
+                vertex.normal = {attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1], attrib.normals[3 * index.normal_index + 2]};
+            }
+            if (index.texcoord_index >= 0)
+            {
+                vertex.uv = {attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1]};
+            }
+
+            auto const new_index   = static_cast<uint32_t>(builder.vertices.size());
+            auto const found_index = unique_vertices.find_or_insert(vertex, new_index);
+            if (found_index == new_index)
+            {
+                builder.vertices.push_back(vertex);
+            }
+            builder.indices.push_back(found_index);
+        }
+    }
+
+    void compare(std::string const &file_path, uint32_t thread_count)
+    {
+        tinyobj::attrib_t                attrib;
+        std::vector<tinyobj::shape_t>    shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string                      warn, err;
+        if (not tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file_path.c_str()))
+        {
+            expect(false, file_path, ("tinyobj failed: " + warn + err).c_str());
+            return;
+        }
+
+        std::vector<tinyobj::index_t> tinyobj_corners{};
+        for (auto const &shape : shapes)
+        {
+            tinyobj_corners.insert(tinyobj_corners.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+        }
+
+        obj_parser::result obj{};
+        expect(obj_parser::parse(file_path, obj, thread_count), file_path, "obj_parser refused a file without polygons");
+
+        expect(obj.vertices == attrib.vertices, file_path, "positions differ");
+        expect(obj.colors == attrib.colors, file_path, "colors differ");
+        expect(obj.normals == attrib.normals, file_path, "normals differ");
+        expect(obj.texcoords == attrib.texcoords, file_path, "texcoords differ");
+
+        bool same_corners = obj.indices.size() == tinyobj_corners.size();
+        for (size_t i = 0; same_corners and i < obj.indices.size(); ++i)
+        {
+            same_corners = obj.indices[i].vertex_index == tinyobj_corners[i].vertex_index
+                and obj.indices[i].normal_index == tinyobj_corners[i].normal_index
+                and obj.indices[i].texcoord_index == tinyobj_corners[i].texcoord_index;
+        }
+        expect(same_corners, file_path, "corners differ");
+
+        builder_arrays parsed{};
+        vertex_dedup_table parsed_table{parsed.vertices, obj.indices.size()};
+        append_corners(parsed, parsed_table, obj, obj.indices);
+
+        builder_arrays reference{};
+        vertex_dedup_table reference_table{reference.vertices, tinyobj_corners.size()};
+        append_corners(reference, reference_table, attrib, tinyobj_corners);
+
+        expect(parsed.vertices == reference.vertices, file_path, "builder vertices differ");
+        expect(parsed.indices == reference.indices, file_path, "builder indices differ");
+    }
+
+    auto with_crlf(std::filesystem::path const &source, std::filesystem::path const &target) -> std::string
+    {
+        std::ifstream input{source, std::ios::binary};
+        std::ofstream output{target, std::ios::binary};
+        for (std::string line; std::getline(input, line);)
+        {
+            output << line << "\r\n";
+        }
+        return target.string();
+    }
+}
+
+int main()
+{
+    std::filesystem::path const fixtures{TEST_DATA_DIR "obj"};
+    std::filesystem::path const scratch = std::filesystem::temp_directory_path() / "obj_parser_test";
+    std::filesystem::create_directories(scratch);
+
+    for (char const *name : {"triangles.obj", "relative.obj", "quads.obj", "colors.obj"})
+    {
+        compare((fixtures / name).string(), 1);
+        compare(with_crlf(fixtures / name, scratch / name), 1);
+    }
+
+    // Left to tinyobj's ear clipping
+    obj_parser::result polygons{};
+    expect(not obj_parser::parse((fixtures / "polygons.obj").string(), polygons), "polygons.obj", "obj_parser accepted a pentagon");
+
+    for (char const *newline : {"\n", "\r\n"})
+    {
+        std::string const large = (scratch / (newline[0] == '\r' ? "large_crlf.obj" : "large.obj")).string();
+        write_generated_obj(large, 160, newline);
+        for (uint32_t const thread_count : {1u, 3u, 8u})
+        {
+            compare(large, thread_count);
+        }
+    }
+
+    std::filesystem::remove_all(scratch);
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " mismatches between obj_parser and tinyobj\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "obj_parser matches tinyobj\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+﻿// Times transform_kernel::compose on every instruction set against compose_one called per transform, the one at a
+// time path it replaces. The transform count is the first argument, 100000 without one.
+
+// Project includes
+#include "src/core/transform_kernel.h"
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int runs = 20;
+
+    // Best of runs, in milliseconds
+    template <typename task_t>
+    auto best_time(task_t const &task) -> double
+    {
+        double best = 1e30;
+        for (int run = 0; run < runs; ++run)
+        {
+            auto const start = std::chrono::steady_clock::now();
+            task();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    using namespace dae;
+    using instruction_set = transform_kernel::instruction_set;
+
+    size_t const count = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+    std::mt19937 random{23};
+    std::uniform_real_distribution<float> distribution{-10.0f, 10.0f};
+    std::array<std::vector<float>, 9> components{};
+    for (auto &component : components)
+    {
+        component.resize(count);
+        std::generate(component.begin(), component.end(), [&] { return distribution(random); });
+    }
+    transform_soa const input{
+        components[0].data(), components[1].data(), components[2].data(),
+        components[3].data(), components[4].data(), components[5].data(),
+        components[6].data(), components[7].data(), components[8].data()};
+
+    std::vector<glm::mat4> world(count);
+    std::vector<glm::mat4> normal(count);
+
+    std::cout << count << " transforms, best of " << runs << " runs\n";
+
+    double const one_at_a_time = best_time([&]
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            transform_kernel::compose_one(
+                {components[0][i], components[1][i], components[2][i]},
+                {components[3][i], components[4][i], components[5][i]},
+                {components[6][i], components[7][i], components[8][i]},
+                world[i],
+                normal[i]);
+        }
+    });
+    std::cout << "\tcompose_one " << one_at_a_time << " ms\n";
+
+    for (instruction_set const set : {instruction_set::scalar, instruction_set::sse2, instruction_set::avx2})
+    {
+        if (set == instruction_set::avx2 and transform_kernel::best_instruction_set() != instruction_set::avx2)
+        {
+            std::cout << "\tavx2 not supported by this CPU\n";
+            continue;
+        }
+
+        double const batched = best_time([&] { transform_kernel::compose(set, input, count, world.data(), normal.data()); });
+        std::cout << '\t' << transform_kernel::instruction_set_name(set) << std::string(11 - std::string{transform_kernel::instruction_set_name(set)}.size(), ' ')
+                  << batched << " ms, " << one_at_a_time / batched << "x\n";
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+﻿// Holds every instruction set of transform_kernel::compose to compose_one, for every count up to a few vector widths
+// so all the tails are covered, and for a few large odd counts.
+
+// Project includes
+#include "src/core/transform_kernel.h"
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using namespace dae;
+    using instruction_set = transform_kernel::instruction_set;
+
+    // Relative to the element, or absolute below 1. The polynomial sin and cos stay within a few ulp.
+    constexpr double tolerance = 1e-5;
+
+    // Past the last written matrix, compose must leave it alone
+    constexpr size_t guard_count = 9;
+    glm::mat4 const  guard{-7.0f};
+
+    auto error(glm::mat4 const &value, glm::mat4 const &reference) -> double
+    {
+        double worst = 0.0;
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                double const scale = std::max(1.0, std::abs(double{reference[column][row]}));
+                worst = std::max(worst, std::abs(double{value[column][row]} - double{reference[column][row]}) / scale);
+            }
+        }
+        return worst;
+    }
+
+    auto test(std::mt19937 &random, size_t count) -> int
+    {
+        std::uniform_real_distribution<float> translation{-100.0f, 100.0f};
+        std::uniform_real_distribution<float> rotation{-50.0f, 50.0f};
+        std::uniform_real_distribution<float> scale{0.01f, 10.0f};
+
+        std::array<std::vector<float>, 9> components{};
+        for (size_t component = 0; component < components.size(); ++component)
+        {
+            components[component].resize(count);
+            for (float &value : components[component])
+            {
+                value = component < 3 ? translation(random) : component < 6 ? rotation(random) : scale(random);
+            }
+        }
+        transform_soa const input{
+            components[0].data(), components[1].data(), components[2].data(),
+            components[3].data(), components[4].data(), components[5].data(),
+            components[6].data(), components[7].data(), components[8].data()};
+
+        std::vector<glm::mat4> reference_world(count);
+        std::vector<glm::mat4> reference_normal(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            transform_kernel::compose_one(
+                {components[0][i], components[1][i], components[2][i]},
+                {components[3][i], components[4][i], components[5][i]},
+                {components[6][i], components[7][i], components[8][i]},
+                reference_world[i],
+                reference_normal[i]);
+        }
+
+        int failures = 0;
+        for (instruction_set const set : {instruction_set::scalar, instruction_set::sse2, instruction_set::avx2})
+        {
+            std::vector<glm::mat4> world(count + guard_count, guard);
+            std::vector<glm::mat4> normal(count + guard_count, guard);
+            transform_kernel::compose(set, input, count, world.data(), normal.data());
+
+            double worst = 0.0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                worst = std::max({worst, error(world[i], reference_world[i]), error(normal[i], reference_normal[i])});
+            }
+            bool const guards_intact = std::all_of(world.begin() + count, world.end(), [](glm::mat4 const &m) { return m == guard; })
+                and std::all_of(normal.begin() + count, normal.end(), [](glm::mat4 const &m) { return m == guard; });
+
+            if (worst > tolerance or not guards_intact)
+            {
+                std::cerr << transform_kernel::instruction_set_name(set) << ", " << count << " transforms: relative error " << worst
+                          << (guards_intact ? "\n" : ", wrote past the end\n");
+                ++failures;
+            }
+        }
+        return failures;
+    }
+}
+
+int main()
+{
+    std::mt19937 random{23};
+
+    int failures = 0;
+    for (size_t count = 0; count <= 40; ++count)
+    {
+        failures += test(random, count);
+    }
+    for (size_t const count : {127u, 1001u, 65537u})
+    {
+        failures += test(random, count);
+    }
+
+    // avx2 falls back to sse2 on CPUs without it, so this says what was actually covered
+    std::cout << "best instruction set " << transform_kernel::instruction_set_name(transform_kernel::best_instruction_set()) << ", "
+              << failures << " failures\n";
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}